@@ -0,0 +1,62 @@
+#pragma once
+
+#include "report.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace sla {
+
+struct AllanOptions
+{
+    std::filesystem::path input_path;     // "-" = stdin
+    std::filesystem::path output_path;    // .csv -> CSV table, anything else -> JSON
+
+    unsigned threads{0};                  // 0 = hardware_concurrency
+    int points_per_decade{10};            // log spacing of cluster sizes
+};
+
+// One cluster size m (tau = m * tau0), overlapping ADEV for ax, ay, az
+struct AllanPoint
+{
+    std::uint64_t m{};
+    double tau_s{};
+    std::uint64_t terms{};                // N + 1 - 2m second differences averaged
+    std::array<double, 3> adev{};
+};
+
+struct AllanResult
+{
+    bool ok{true};
+    std::string error;
+
+    std::string input_name;
+    Counts counts{};
+    double tau0_s{};                      // median sample interval
+    std::vector<AllanPoint> points;
+};
+
+// Log-spaced cluster sizes 1 .. (n - 1) / 2, about points_per_decade per decade, no repeats
+std::vector<std::uint64_t> allan_cluster_sizes(std::uint64_t n, int points_per_decade);
+
+// Overlapping Allan deviation for cluster size m from the prefix sums
+// cum[k] = sum of the first k samples (cum.size() = N + 1), in sample units:
+//   sigma^2 = sum_k (cum[k+2m] - 2 cum[k+m] + cum[k])^2 / (2 m^2 (N + 1 - 2m))
+// O(N) per m instead of re-averaging clusters
+double overlapping_adev(const std::vector<double> &cum, std::uint64_t m);
+
+// Reads the input once, keeps one prefix-sum column per axis in memory
+// (8 bytes per row and axis) and evaluates the taus on a thread pool
+AllanResult run_allan(const AllanOptions &opt);
+
+// <input stem>_allan.json next to the input
+std::filesystem::path make_allan_path(const std::filesystem::path &input);
+
+// Writes the JSON or CSV result (by output_path extension), "-" = stdout as JSON
+bool write_allan_result(const AllanResult &r, const std::filesystem::path &output_path, std::string &error);
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "calibration.hpp"
+#include "report.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+
+namespace sla {
+
+// a_corr = C * (raw - b), as written by `sla calib` in "coeffs"
+struct Correction
+{
+    Mat3 C{};
+    Vec3 b{};
+};
+
+// Reads coeffs.C and coeffs.b from a calib JSON. On failure sets error
+bool load_correction(const std::filesystem::path &calib_json, Correction &out, std::string &error);
+
+// Corrects n samples given as separate ax/ay/az columns (SoA). Uses the AVX2
+// kernel when the CPU has it; results are bit-identical to the scalar one
+// (same operation order, separate multiply and add - no FMA)
+void apply_correction(const Correction &k,
+                      const double *ax, const double *ay, const double *az,
+                      double *out_x, double *out_y, double *out_z, std::size_t n);
+
+void apply_correction_scalar(const Correction &k,
+                             const double *ax, const double *ay, const double *az,
+                             double *out_x, double *out_y, double *out_z, std::size_t n);
+
+// true if apply_correction runs the AVX2 kernel on this machine
+bool correction_kernel_is_avx2();
+
+struct ApplyOptions
+{
+    std::filesystem::path input_path;     // "-" = stdin
+    std::filesystem::path coeffs_path;    // calib JSON
+    std::filesystem::path output_path;    // "-" = stdout
+    std::uint64_t max_rows{0};            // only correct the first max_rows rows; 0 = all
+};
+
+struct ApplyResult
+{
+    bool ok{true};
+    std::string error;
+
+    std::string input_name;
+    Counts counts{};
+    std::uint64_t rows_out{};
+};
+
+// One streaming pass: rows are gathered into SoA batches, corrected and
+// written with the buffered CSV writer
+ApplyResult run_apply(const ApplyOptions &opt);
+
+}
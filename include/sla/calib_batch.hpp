@@ -0,0 +1,68 @@
+#pragma once
+
+#include "calibration.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace sla {
+
+struct BatchOptions
+{
+    std::filesystem::path dir;             // one CSV (.csv/.csv.gz/.csv.zst) per device
+    std::filesystem::path position_path;   // shared POSITION.txt
+    std::filesystem::path summary_path;    // CSV, one row per device
+
+    unsigned threads{0};                   // devices in parallel, 0 = hardware_concurrency
+    double max_residual{0.01};             // pass: max fit residual (m/s^2) at most this
+
+    // settings for every device; paths are filled in per device
+    CalibrationOptions calib{};
+};
+
+struct BatchDevice
+{
+    std::filesystem::path input;
+    CalibrationResult result;
+    bool pass{false};
+};
+
+// A CSV in the batch directory that isn't calibrated, and why
+struct BatchSkip
+{
+    std::filesystem::path input;
+    std::string reason;
+};
+
+struct BatchResult
+{
+    bool ok{true};
+    std::string error;
+
+    std::vector<BatchDevice> devices;      // sorted by file name
+    std::vector<BatchSkip> skipped;        // sorted by file name
+    std::size_t passed{};
+};
+
+// Device inputs of a batch directory, sorted by name: CSV files except the
+// summary and sla's own outputs (names ending in _calib.csv, _calib_sweep.csv,
+// _clean.csv or _resampled.csv). Of inputs that would write the same outputs
+// (d.csv, d.csv.gz, d.csv.zst) only the first by name is kept. Everything
+// left out is reported in skipped
+std::vector<std::filesystem::path> list_batch_inputs(const std::filesystem::path &dir,
+                                                     const std::filesystem::path &exclude,
+                                                     std::vector<BatchSkip> *skipped = nullptr);
+
+// POSITION.txt is parsed (and gravity_true computed) once; devices run on a
+// thread pool, each writing its <stem>_calib.csv/.json next to its input
+BatchResult run_calibration_batch(const BatchOptions &opt);
+
+// <dir>/calib_summary.csv
+std::filesystem::path make_batch_summary_path(const std::filesystem::path &dir);
+
+bool write_batch_summary(const BatchResult &r, const std::filesystem::path &path, std::string &error);
+
+}
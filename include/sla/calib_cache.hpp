@@ -0,0 +1,66 @@
+#pragma once
+
+#include "calibration.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+
+namespace sla {
+
+// 64-bit FNV-1a
+class Fnv1a64
+{
+public:
+    void add(const void *data, std::size_t n);
+
+    template <class T>
+    void add_value(const T &v) { add(&v, sizeof(v)); }
+
+    std::uint64_t value() const { return h_; }
+
+private:
+    std::uint64_t h_{0xcbf29ce484222325ull};
+};
+
+// Size, mtime and a hash of sampled blocks of a file: the whole file up to
+// SAMPLE_BLOCKS * SAMPLE_BLOCK bytes, else SAMPLE_BLOCKS evenly spaced
+// blocks including the first and the last. False if it can't be read
+inline constexpr std::size_t CACHE_SAMPLE_BLOCK = 64 * 1024;
+inline constexpr std::size_t CACHE_SAMPLE_BLOCKS = 16;
+
+bool fingerprint_file(const std::filesystem::path &path, Fnv1a64 &h);
+
+// Cache key of one calibration: the input fingerprint, the parsed positions,
+// gravity, steady fractions, auto-steady and bootstrap settings (not the
+// thread count - the results don't depend on it)
+bool calib_cache_key(const CalibrationOptions &opt, const CalibrationPositions &positions, std::uint64_t &key);
+
+// What a cache hit needs to skip the fit: the result (with the per-position
+// means), the JSON report as written, and the stamp of the corrected CSV it
+// wrote so that a deleted or replaced CSV is regenerated
+struct CalibCacheEntry
+{
+    std::uint64_t key{};
+    CalibrationResult result;
+    std::string report;
+
+    std::uint64_t output_size{};
+    std::int64_t output_mtime{};
+};
+
+// <dir>/<key as 16 hex digits>.json
+std::filesystem::path calib_cache_entry_path(const std::filesystem::path &dir, std::uint64_t key);
+
+// False on a miss, including an unreadable or stale-format entry
+bool load_calib_cache_entry(const std::filesystem::path &dir, std::uint64_t key, CalibCacheEntry &out);
+
+// Written to a temporary file and renamed into place
+bool store_calib_cache_entry(const std::filesystem::path &dir, const CalibCacheEntry &entry, std::string &error);
+
+// Size and mtime of a file; false if it doesn't exist
+bool file_stamp(const std::filesystem::path &path, std::uint64_t &size, std::int64_t &mtime);
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "calibration.hpp"
+#include "doubling_chunks.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace sla {
+
+// Count, sums and sums of squares of ax/ay/az over a run of rows
+struct AxisMoments
+{
+    std::uint64_t n{};
+    std::array<double, 3> sum{};
+    std::array<double, 3> sum_sq{};
+
+    void add(const AxisMoments &o);
+};
+
+// Moments of a whole capture in DoublingChunks (~2^17 chunks, a few MB),
+// turned into prefix sums so a window's moments take two lookups. Values are
+// stored relative to the first row so that the sums of squares don't lose
+// the variance against g^2
+class SubBlockSums
+{
+public:
+    static constexpr std::size_t DEFAULT_MAX_CHUNKS = std::size_t{1} << 17;
+
+    explicit SubBlockSums(std::size_t max_chunks = DEFAULT_MAX_CHUNKS);
+
+    void add(double ax, double ay, double az);
+
+    // Builds the prefix sums; call once after the last add()
+    void finish();
+
+    std::uint64_t rows() const { return chunks_.rows(); }
+    std::uint64_t chunk_rows() const { return chunks_.chunk_rows(); }
+    std::array<double, 3> offset() const { return ref_; }
+
+    // Moments of rows [begin, end), both rounded to the nearest chunk
+    // boundary (end >= rows() takes the last, partial chunk too); sums are
+    // relative to offset()
+    AxisMoments range(std::uint64_t begin, std::uint64_t end) const;
+
+private:
+    DoublingChunks<AxisMoments> chunks_;
+    std::array<double, 3> ref_{};
+
+    std::vector<AxisMoments> prefix_;   // after finish(): moments of the first i chunks
+};
+
+struct SweepOptions
+{
+    std::filesystem::path input_path;
+    std::filesystem::path position_path;
+    std::filesystem::path output_path;   // CSV table
+
+    double gravity{9.81054};
+    double step{0.05};        // grid of steady_start_frac / steady_end_frac
+    double min_width{0.1};    // end_frac - start_frac
+    unsigned threads{0};      // 0 = hardware_concurrency
+};
+
+// Fit quality for one (start_frac, end_frac) pair
+struct SweepWindow
+{
+    double start_frac{};
+    double end_frac{};
+    std::uint64_t rows{};       // steady rows per position (after chunk rounding)
+
+    bool ok{false};             // false: the fit failed (singular system)
+    double fit_rms{};           // |mean - (M*a_true + b)| over positions, RMS
+    double fit_max{};
+    double mag_err_max{};       // max | |C*(mean - b)| - g |
+    double noise_std_max{};     // max per-position accel std in the window (rotation leaking in)
+};
+
+struct SweepResult
+{
+    bool ok{true};
+    std::string error;
+
+    std::uint64_t parsed_lines{};
+    int npos{};
+    std::uint64_t L{};
+    std::uint64_t chunk_rows{};
+    std::vector<SweepWindow> windows;
+    std::size_t best{};         // index of the lowest fit_rms
+};
+
+// Equal blocks as in run_calibration. Reads the input once into
+// SubBlockSums, then fits every window of the grid in O(npos) on a thread pool
+SweepResult run_calibration_sweep(const SweepOptions &opt);
+
+// <input stem>_calib_sweep.csv next to the input
+std::filesystem::path make_sweep_path(const std::filesystem::path &input);
+
+bool write_sweep_csv(const SweepResult &r, const std::filesystem::path &path, std::string &error);
+
+}
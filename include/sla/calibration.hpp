@@ -1,9 +1,14 @@
 #pragma once
 
+#include "steady.hpp"
 #include "welford_stats.hpp"
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <string>
+#include <vector>
 
 
 namespace sla {
@@ -12,13 +17,32 @@ struct Vec3 { double x{}, y{}, z{}; };
 
 struct Mat3 { double a[3][3]{}; };
 
+// How a position's dwell is located in the capture
+enum class PositionRange
+{
+    Equal,   // no range columns: N rows split into npos equal blocks
+    Rows,    // ROW_START / ROW_END: parsed-row indices, end exclusive
+    Time     // T_START / T_END: t_ms, end exclusive
+};
+
 struct Position
 {
-    int inner{};
-    int outer{};
+    double inner{};
+    double outer{};
+
+    // dwell, when POSITION.txt has range columns (see PositionRange)
+    double begin{};
+    double end{};
 };
 
 
+struct BootstrapOptions
+{
+    std::size_t replicates{0};    // 0 = off
+    unsigned threads{0};          // 0 = hardware_concurrency
+    std::uint64_t seed{1};        // same seed -> same intervals, whatever the thread count
+};
+
 struct CalibrationOptions
 {
     std::filesystem::path input_path;
@@ -28,37 +52,195 @@ struct CalibrationOptions
     double gravity{9.81054};
     double steady_start_frac{0.3};
     double steady_end_frac{0.7};
+
+    // window > 0: find the steady segments from the data instead of the
+    // fixed fractions (POSITION.txt without range columns only)
+    SteadyOptions auto_steady{};
+
+    BootstrapOptions bootstrap{};
+
+    bool verbose{true};    // per-position fit errors and steady stats on stdout
+
+    // non-empty: look the result up by input fingerprint and settings first
+    // (see calib_cache.hpp); a hit skips the fit and only rewrites the outputs
+    std::filesystem::path cache_dir;
+};
+
+// POSITION.txt parsed once, with the reference gravity of every position
+// (shared by all devices of a batch)
+struct CalibrationPositions
+{
+    std::vector<Position> positions;
+    PositionRange range{PositionRange::Equal};
+    std::vector<Vec3> a_true;
+};
+
+// Spread of the 24 coefficients over the bootstrap replicates, in the order
+// M (row-major), b, C (row-major), d
+struct CoefficientSpread
+{
+    std::array<double, 24> se{};     // standard deviation over the replicates
+    std::array<double, 24> p2_5{};   // 95% percentile interval
+    std::array<double, 24> p97_5{};
+};
+
+struct BootstrapResult
+{
+    std::size_t replicates{};     // 0: not run
+    std::size_t failed{};         // replicates whose fit was singular (left out)
+    std::size_t sub_blocks{};     // per position
+    CoefficientSpread spread{};
 };
 
+// Steady samples of one position cut into consecutive sub-blocks, kept as
+// sums: a bootstrap replicate draws sub-blocks with replacement, which
+// keeps short-range correlation inside a draw (moving-block style)
+inline constexpr std::size_t BOOTSTRAP_SUB_BLOCKS = 64;
+
+struct PositionSubBlocks
+{
+    std::vector<Vec3> sum;
+    std::vector<std::uint64_t> n;
+};
+
+// Refits M, b from resampled position means on a thread pool
+BootstrapResult bootstrap_calibration(
+    const std::vector<Vec3> &a_true,
+    const std::vector<PositionSubBlocks> &blocks,
+    const BootstrapOptions &opt);
+
 
 struct CalibrationResult
 {
     bool ok{true};
     std::string error;
 
-    std::size_t parsed_lines{};
+    std::uint64_t parsed_lines{};
+    std::uint64_t used_lines{};    // rows written to the corrected CSV (equal blocks drop the tail)
+    bool cache_hit{false};
 
     int npos{};
-    int L{};                 // lines per position
-    int steady_start{};      // index of the beginning of the steady window within the block
-    int steady_end{};        // index of the end of the steady window within the block
+    std::uint64_t L{};             // lines per position
+    std::uint64_t steady_start{};  // index of the beginning of the steady window within the block
+    std::uint64_t steady_end{};    // index of the end of the steady window within the block
+    std::uint64_t steady_segments{};   // auto_steady: segments detected (matched or not)
+
+    double design_cond{};    // 2-norm condition number of the design matrix [a_true 1]
+    double fit_residual_max{};   // max |mean - (M*a_true + b)| over positions
 
     Mat3 M{};                // measurement model a_meas = M*a_true + b
     Vec3 b{};                // bias in the measurement model
     Mat3 C{};                // correction matrix = inv(M)
     Vec3 d{};                // correction bias -C*b
 
+    std::vector<Vec3> means;   // steady mean reading per position
+
     double max_abs_mag_raw_all{};           // max(|mag_raw - g|) (all)
     double max_abs_mag_raw_steady{};        // per steady window
     double max_abs_mag_corr_steady{};       // per steady window (after correction)
 
     // Statistics |a_corr| in the steady window
     Stats mag_corr_stats{};
+
+    BootstrapResult bootstrap{};
 };
 
 
+// Steady rows [begin, end) of one block
+struct SteadyRange
+{
+    std::uint64_t begin{};
+    std::uint64_t end{};
+    std::uint64_t block{};   // position index
+};
+
+// Which parsed rows belong to which position's steady window. Either
+// N rows split into npos equal blocks of L rows (the N % npos tail is not
+// used), or explicit per-position row ranges of any length
+struct BlockLayout
+{
+    std::uint64_t npos{};
+    std::uint64_t n_used{};
+    std::uint64_t L{};             // equal blocks only
+    std::uint64_t steady_start{};  // [steady_start, steady_end) within every equal block
+    std::uint64_t steady_end{};
+
+    std::vector<SteadyRange> ranges;   // explicit layout, sorted by begin; empty for equal blocks
+
+    // row: 0-based index among parsed rows. Sets block and returns true
+    // if the row lies in the steady window of its block
+    bool steady_block(std::uint64_t row, std::uint64_t &block) const
+    {
+        if (row >= n_used)
+            return false;
+
+        if (!ranges.empty())
+            return steady_range_block(row, block);
+
+        block = row / L;
+        const std::uint64_t offset = row % L;
+        return steady_start <= offset && offset < steady_end;
+    }
+
+private:
+    bool steady_range_block(std::uint64_t row, std::uint64_t &block) const;
+};
+
+BlockLayout make_block_layout(
+    std::uint64_t N,
+    std::uint64_t npos,
+    double steady_start_frac,
+    double steady_end_frac);
+
+// Explicit layout: dwell [begin, end) in parsed rows per position; the
+// steady fractions are applied inside every dwell. Ranges must not overlap
+BlockLayout make_block_layout(
+    std::uint64_t N,
+    const std::vector<std::array<std::uint64_t, 2>> &dwell,
+    double steady_start_frac,
+    double steady_end_frac);
+
+// Explicit steady ranges as they are (several per position allowed)
+BlockLayout make_block_layout(
+    std::uint64_t N,
+    std::uint64_t npos,
+    std::vector<SteadyRange> ranges);
+
 CalibrationResult run_calibration(const CalibrationOptions &opt);
 
+// With POSITION.txt already loaded; opt.position_path is not read
+CalibrationResult run_calibration(const CalibrationOptions &opt, const CalibrationPositions &positions);
+
+// read_position + gravity_true for every position
+bool load_calibration_positions(const std::filesystem::path &path, double gravity,
+                                CalibrationPositions &out, std::string &error);
+
+// Least squares M, b of a_meas = M*a_true + b from the mean reading of
+// every position (3 equations each, npos >= 4). The axes decouple into
+// three 4-unknown problems with the same design matrix [a_true 1]: one
+// 4x4 Cholesky factorization, three solves. On failure sets error
+bool fit_calibration(const std::vector<Vec3> &a_true, const std::vector<Vec3> &means,
+                     Mat3 &M, Vec3 &b, std::string &error);
+
+// Same, also reporting the condition number of the design matrix
+// (large: the positions don't span the orientations well)
+bool fit_calibration(const std::vector<Vec3> &a_true, const std::vector<Vec3> &means,
+                     Mat3 &M, Vec3 &b, double &cond, std::string &error);
+
+// Returns false if det ~ 0
+bool invert_mat3(const Mat3 &M, Mat3 &Minv, std::string &error);
+
+// Reads POSITION.txt: a header line naming the columns, then one position
+// per line. The first two columns are the inner and outer angles (degrees)
+// whatever their names; optional ROW_START ROW_END or T_START T_END columns
+// give each position's dwell (range, if given, is set to Rows / Time).
+// On failure returns {} and sets error
+std::vector<Position> read_position(const std::filesystem::path &path, std::string &error);
+std::vector<Position> read_position(const std::filesystem::path &path, PositionRange &range, std::string &error);
+
+// Reference gravity vector in the sensor frame for turntable angles (degrees)
+Vec3 gravity_true(double g, double inner_deg, double outer_deg);
+
 
 
 
@@ -1,5 +1,14 @@
 #pragma once
 
+#include "synth.hpp"
+#include "resample.hpp"
+#include "allan.hpp"
+#include "hampel.hpp"
+#include "steady.hpp"
+#include "calib_sweep.hpp"
+#include "calib_batch.hpp"
+
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <variant>
@@ -12,14 +21,37 @@ enum class Command
 {
     None,   // ./program --input data.csv  # Command::None (analysis only)
     Clean,   // ./program --input data.csv --clean  # Command::Clean (analysis + record clean CSV)
-    Calib
+    Calib,
+    Gen,    // ./program gen --output big.csv --rows 100000000  # synthetic capture
+    Resample, // ./program resample --input data.csv --rate 1000  # uniform time grid
+    Allan,  // ./program allan --input data.csv  # Allan deviation per axis
+    Apply   // ./program apply --input data.csv --coeffs data_calib.json  # correction only, no fit
 };
 
 struct Options
 {
     std::string input_file;
     std::string position_file;
+    std::string output_file;   // (clean, resample, apply, gen) output CSV, (allan) JSON/CSV; "-" = stdout
+    std::string coeffs_file;   // (apply) calib JSON with coeffs.C and coeffs.b
+    std::string report_file;   // (analyze, clean) JSON report; "-" = stdout
+    std::string rejects_file;  // (clean) bad lines as line,reason,raw CSV; empty = off
     Command cmd{Command::None};
+    std::uint64_t reorder_window{0};   // (clean) 0 = pass rows through in input order
+    bool dedup{false};                 // (clean) drop exact duplicate rows while reordering
+    HampelOptions hampel{};            // (clean) half_window 0 = off
+    SteadyOptions steady{};            // (calib) automatic steady segments, window 0 = off
+    bool sweep{false};                 // (calib) fit a grid of steady windows instead of one
+    SweepOptions sweep_opt{};          // (calib --sweep) paths are filled in by main
+    BootstrapOptions bootstrap{};      // (calib) replicates 0 = off
+    std::string batch_dir;             // (calib) one device CSV per file instead of --input
+    double max_residual{0.01};         // (calib --batch) pass/fail limit
+    std::string cache_dir;             // (calib) result cache, empty = off
+    std::uint64_t psd_window{0};       // (analyze, clean) Welch PSD window, 0 = off
+    SynthOptions gen{};        // (gen) generator settings
+    ResampleOptions resample{};   // (resample) grid settings; paths are filled in by main
+    bool rate_set{false};         // (resample) --rate was given
+    AllanOptions allan{};         // (allan) paths are filled in by main
     bool show_help{false};
 };
 
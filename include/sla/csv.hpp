@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <string>
 #include <string_view>
@@ -28,14 +29,55 @@ struct CsvStreamResult
     Counts counts;
     std::vector<Warning> warnings;
 
-    std::size_t warnings_dropped{};
+    std::uint64_t warnings_dropped{};
+
+    // every bad line, by category
+    std::vector<WarningCategory> warning_categories;
+};
+
+// Where a parsed row came from: 1-based line number (as in warnings) and
+// byte offset of the line start in the (decompressed) input
+struct RowLocation
+{
+    std::uint64_t line{};
+    std::uint64_t byte_offset{};
+};
+
+// A bad line: wrong number of columns or a value that isn't a number.
+// The views are only valid during the callback
+struct RejectedLine
+{
+    std::uint64_t line{};
+    WarningKind kind{};
+    std::size_t detail{};     // as in WarningCategory: columns found / 1-based column
+    std::string_view text;    // the line as read (without the line break)
 };
 
 using CsvRowCallback = std::function<void(const std::array<double, 4>&)>;
+using CsvLocatedRowCallback = std::function<void(const std::array<double, 4>&, const RowLocation&)>;
+using CsvRejectCallback = std::function<void(const RejectedLine&)>;
 
 CsvStreamResult read_imu_csv_streaming(
     const std::filesystem::path &path,
     const CsvRowCallback &on_row
 );
 
+// Same parse, but also tells the callback where each row is in the input;
+// on_reject (optional) gets every bad line
+CsvStreamResult read_imu_csv_streaming_located(
+    const std::filesystem::path &path,
+    const CsvLocatedRowCallback &on_row,
+    const CsvRejectCallback &on_reject = {}
+);
+
+// Parses an uncompressed file from byte offset (the start of a line, e.g. a
+// RowLocation::byte_offset) and stops after max_rows parsed rows. Line
+// numbers in warnings count from there. Fails for stdin/compressed inputs
+CsvStreamResult read_imu_csv_streaming_at(
+    const std::filesystem::path &path,
+    std::uint64_t byte_offset,
+    std::uint64_t max_rows,
+    const CsvRowCallback &on_row
+);
+
 }
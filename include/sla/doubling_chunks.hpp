@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+namespace sla {
+
+// Per-chunk summaries of a row stream whose length isn't known up front:
+// chunks start at one row and double in size whenever their number reaches
+// max_chunks (neighbours merged with Chunk::add(const Chunk &next)), so
+// memory stays bounded. Chunk i covers rows [i * chunk_rows(), (i + 1) *
+// chunk_rows()); the last one may be partial. Shared by the sweep's
+// SubBlockSums and calib's RowChunkSums, which differ only in what a chunk holds
+template <typename Chunk>
+class DoublingChunks
+{
+public:
+    explicit DoublingChunks(std::size_t max_chunks)
+        : max_chunks_(std::max<std::size_t>(2, max_chunks & ~std::size_t{1}))
+    {
+        chunks_.reserve(max_chunks_);
+    }
+
+    // fill(chunk, first) folds one row into its chunk; first is true for the
+    // chunk's first row (a fresh, value-initialised Chunk)
+    template <typename Fill>
+    void add(Fill &&fill)
+    {
+        const bool first = partial_rows_ == 0;
+        if (first)
+            chunks_.emplace_back();
+
+        rows_++;
+        fill(chunks_.back(), first);
+
+        if (++partial_rows_ < chunk_rows_)
+            return;
+        partial_rows_ = 0;
+
+        if (chunks_.size() == max_chunks_)
+        {
+            // halve the resolution: merge neighbours
+            for (std::size_t i = 0; i < max_chunks_ / 2; ++i)
+            {
+                chunks_[i] = chunks_[2 * i];
+                chunks_[i].add(chunks_[2 * i + 1]);
+            }
+            chunks_.resize(max_chunks_ / 2);
+            chunk_rows_ *= 2;
+        }
+    }
+
+    // Closes the last, partial chunk
+    void finish() { partial_rows_ = 0; }
+
+    std::uint64_t rows() const { return rows_; }
+    std::uint64_t chunk_rows() const { return chunk_rows_; }
+
+    const std::vector<Chunk> &chunks() const { return chunks_; }
+    std::vector<Chunk> take() { return std::exchange(chunks_, {}); }
+
+private:
+    std::size_t max_chunks_;
+    std::uint64_t chunk_rows_{1};
+    std::uint64_t rows_{0};
+    std::uint64_t partial_rows_{0};
+
+    std::vector<Chunk> chunks_;
+};
+
+}
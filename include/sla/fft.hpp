@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+
+namespace sla {
+
+// Radix-2 FFT of a real sequence of length n (power of two, >= 4).
+// Runs an n/2-point complex FFT on the even/odd samples packed as re/im
+// and untangles the result. Real and imaginary parts live in separate
+// arrays so the butterfly loops are plain (vectorizable) double loops.
+// Twiddles and the bit-reversal table are computed once per size
+class RealFft
+{
+public:
+    explicit RealFft(std::size_t n);
+
+    std::size_t size() const { return n_; }
+
+    // out_re/out_im receive bins 0 .. n/2 (n/2 + 1 values each)
+    void forward(const double *in, double *out_re, double *out_im);
+
+private:
+    void complex_fft();
+
+    std::size_t n_;
+    std::size_t h_;                       // n / 2
+    std::vector<std::size_t> bitrev_;     // for the h-point transform
+    std::vector<double> tw_re_, tw_im_;   // e^{-2 pi i k / n}, k < n/2
+    std::vector<double> re_, im_;         // scratch, h values each
+};
+
+bool is_power_of_two(std::size_t n);
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+
+namespace sla {
+
+// Median and MAD of the last `size` values. The window is kept as a sorted
+// array: binary search to find the slot, memmove to open/close it. For the
+// tens-of-samples windows used here that beats node-based skiplists/heaps;
+// MAD is a two-pointer walk outward from the median, O(size)
+class RollingMedianMad
+{
+public:
+    explicit RollingMedianMad(std::size_t size);
+
+    // Adds x, evicting the oldest value once the window is full
+    void push(double x);
+
+    bool full() const { return count_ == ring_.size(); }
+
+    double median() const;
+    double mad() const;   // median(|x - median|), unscaled
+
+private:
+    std::vector<double> ring_;     // arrival order
+    std::vector<double> sorted_;
+    std::size_t head_{0};
+    std::size_t count_{0};
+};
+
+enum class HampelMode
+{
+    Flag,      // count outliers, keep the row as is
+    Drop,      // drop rows with an outlier on any axis
+    Replace    // replace the outlying value with the window median
+};
+
+bool parse_hampel_mode(std::string_view s, HampelMode &out);
+
+struct HampelOptions
+{
+    std::size_t half_window{0};   // k: window of 2k + 1 rows centered on the tested row; 0 = off
+    double threshold{3.0};        // outlier if |x - median| > threshold * 1.4826 * MAD
+    HampelMode mode{HampelMode::Replace};
+};
+
+struct HampelStats
+{
+    std::uint64_t outliers{};         // values (row x axis) over the threshold
+    std::uint64_t rows_dropped{};
+    std::uint64_t values_replaced{};
+};
+
+// Streaming Hampel filter on ax/ay/az. A row is tested once k rows after it
+// have arrived, so output lags input by k rows; the first and last k rows
+// have no centered window and pass unchanged
+class HampelFilter
+{
+public:
+    using Row = std::array<double, 4>;
+    using Emit = std::function<void(const Row &)>;
+
+    HampelFilter(const HampelOptions &opt, Emit emit);
+
+    void push(const Row &row);
+
+    // Emits the rows still waiting (end of input)
+    void flush();
+
+    const HampelStats &stats() const { return stats_; }
+
+private:
+    HampelOptions opt_;
+    Emit emit_;
+
+    std::array<RollingMedianMad, 3> windows_;
+    std::vector<Row> rows_;         // ring: the same 2k + 1 rows
+    std::size_t head_{0};
+    std::size_t count_{0};
+
+    HampelStats stats_{};
+};
+
+}
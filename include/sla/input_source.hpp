@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace sla {
+
+enum class Compression { None, Gzip, Zstd };
+
+// "-" means stdin for inputs and stdout for outputs
+bool is_stdio_path(const std::filesystem::path &path);
+
+// Sniffs the first bytes of a stream: 1f 8b -> gzip, 28 b5 2f fd -> zstd
+Compression detect_compression(const unsigned char *magic, std::size_t n);
+
+// Sequential byte source. Compressed inputs are decompressed on a background
+// thread into a bounded queue of chunks, so memory stays constant
+class InputSource
+{
+public:
+    virtual ~InputSource() = default;
+
+    // Reads up to n bytes into dst; returns 0 at the end of input or on error
+    virtual std::size_t read(char *dst, std::size_t n) = 0;
+
+    // Empty unless reading/decompression failed
+    virtual std::string error() const = 0;
+
+    virtual Compression compression() const = 0;
+};
+
+// Opens path ("-" = stdin) and picks the decoder by magic bytes (not by extension).
+// Returns nullptr and sets error if the file can't be opened
+std::unique_ptr<InputSource> open_input(const std::filesystem::path &path, std::string &error);
+
+// Opens an uncompressed file positioned at byte offset. Returns nullptr and
+// sets error for stdin and compressed files (not seekable) or a failed seek
+std::unique_ptr<InputSource> open_input_at(const std::filesystem::path &path, std::uint64_t offset,
+                                           std::string &error);
+
+// Splits an InputSource into lines (without '\n') with no per-line allocation.
+// Behaves like std::getline: a trailing '\n' doesn't produce an empty last line
+class LineReader
+{
+public:
+    static constexpr std::size_t DEFAULT_BUFFER = std::size_t{1} << 20;
+
+    explicit LineReader(InputSource &src, std::size_t buffer_size = DEFAULT_BUFFER);
+
+    // Reuses a buffer handed back by take_buffer() (an empty one is allocated)
+    LineReader(InputSource &src, std::vector<char> &&buffer);
+
+    // The view stays valid until the next call
+    bool next(std::string_view &line);
+
+    // Byte offset (in the decompressed stream) of the line last returned by next()
+    std::uint64_t line_offset() const { return line_offset_; }
+
+    // Gives the buffer back for the next reader; this reader is done after that
+    std::vector<char> take_buffer() { return std::move(buf_); }
+
+private:
+    InputSource &src_;
+    std::vector<char> buf_;
+    std::size_t begin_{0};          // unread data is [begin_, end_)
+    std::size_t end_{0};
+    std::size_t scan_{0};           // no '\n' in [begin_, scan_)
+    std::uint64_t buf_offset_{0};   // stream offset of buf_[0]
+    std::uint64_t line_offset_{0};
+    bool eof_{false};
+};
+
+}
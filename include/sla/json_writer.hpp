@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+
+namespace sla {
+
+// Pretty-printed JSON appended straight to a string, with no intermediate
+// tree: byte for byte what nlohmann's dump(4) gives for the same values.
+// Integers are written as integers, doubles as nlohmann does (shortest
+// round-trip, "1.0" not "1", NaN/inf as null); strings are escaped like
+// dump() and invalid UTF-8 throws std::runtime_error, as dump() would throw
+class JsonWriter
+{
+public:
+    explicit JsonWriter(std::string &out, int indent = 4);
+
+    void begin_object();
+    void end_object();
+    void begin_array();
+    void end_array();
+
+    // Key of the next value (inside an object)
+    void key(std::string_view k);
+
+    void value(std::string_view s);
+    void value(const char *s) { value(std::string_view(s)); }
+    void value(const std::string &s) { value(std::string_view(s)); }
+    void value(bool b);
+    void value(double d);
+    void value(std::nullptr_t);
+
+    template <class T>
+        requires(std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    void value(T v)
+    {
+        if constexpr (std::is_signed_v<T>)
+            write_integer(static_cast<std::int64_t>(v));
+        else
+            write_integer(static_cast<std::uint64_t>(v));
+    }
+
+    template <class T>
+    void value(const std::vector<T> &v)
+    {
+        begin_array();
+        for (const auto &x : v)
+            value(x);
+        end_array();
+    }
+
+    // "k": v
+    template <class T>
+    void field(std::string_view k, const T &v)
+    {
+        key(k);
+        value(v);
+    }
+
+private:
+    void prefix();
+    void write_integer(std::int64_t v);
+    void write_integer(std::uint64_t v);
+    void write_string(std::string_view s);
+
+    struct Level
+    {
+        std::size_t count{};
+    };
+
+    std::string &out_;
+    std::size_t indent_;
+    std::vector<Level> stack_;
+    bool after_key_{false};
+};
+
+}
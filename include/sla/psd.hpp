@@ -0,0 +1,59 @@
+#pragma once
+
+#include "fft.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace sla {
+
+// (j["psd"])
+struct PsdReport
+{
+    std::size_t window{};
+    std::uint64_t segments{};
+    double fs_hz{};
+    std::vector<double> freq_hz;                // window/2 + 1 bins
+    std::array<std::vector<double>, 3> psd{};   // ax, ay, az in units^2 / Hz
+};
+
+// Welch PSD: Hann window, 50% overlap, mean removed per segment.
+// Samples arrive one row at a time and live in a ring of `window` values
+// per axis; a segment is transformed every window/2 rows, so memory is
+// O(window) whatever the input length. Assumes uniform sampling; fs is
+// only needed for scaling and is given at report time
+class WelchPsd
+{
+public:
+    // window: power of two >= 4
+    explicit WelchPsd(std::size_t window);
+
+    void update(double ax, double ay, double az);
+
+    PsdReport report(double fs_hz) const;
+
+    std::uint64_t segments() const { return segments_; }
+
+private:
+    void process_segment();
+
+    std::size_t n_;
+    RealFft fft_;
+    std::vector<double> hann_;
+    double hann_power_{0.0};                    // sum w^2
+
+    std::array<std::vector<double>, 3> ring_;
+    std::size_t head_{0};                       // next write position
+    std::uint64_t filled_{0};
+    std::size_t since_last_{0};
+
+    std::array<std::vector<double>, 3> acc_;    // sum |X|^2 per bin
+    std::uint64_t segments_{0};
+
+    std::vector<double> seg_, re_, im_;         // scratch
+};
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "csv.hpp"
+#include "writer.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sla {
+
+// clean --rejects: every bad line as "line,reason,raw" (reason and raw
+// quoted per RFC 4180). The caller only formats into a CHUNK-sized buffer;
+// full chunks go to a writer thread through a queue of at most MAX_QUEUED,
+// so a slow disk holds up parsing only once that queue is full
+class RejectWriter
+{
+public:
+    static constexpr std::size_t CHUNK = std::size_t{1} << 20;
+    static constexpr std::size_t MAX_QUEUED = 4;
+
+    RejectWriter() = default;
+    ~RejectWriter();
+
+    RejectWriter(const RejectWriter &) = delete;
+    RejectWriter &operator=(const RejectWriter &) = delete;
+
+    // Writes the header and starts the writer thread. Files only, not stdout
+    bool open(const std::filesystem::path &path);
+    bool is_open() const { return worker_.joinable(); }
+
+    void write(const RejectedLine &r);
+
+    // Hands over the last chunk and waits for the writer thread
+    void close();
+
+    // false once a write has failed; valid after close()
+    bool ok() const;
+
+    std::uint64_t rejects() const { return rejects_; }
+
+private:
+    void push();
+    void run();
+
+    BufferedWriter out_{64};   // chunks are written straight through
+
+    std::thread worker_;
+    mutable std::mutex m_;
+    std::condition_variable cv_;
+    std::deque<std::vector<char>> queue_;
+    bool done_{false};
+    bool failed_{false};
+
+    std::vector<char> fill_;   // caller side
+    std::uint64_t rejects_{0};
+};
+
+}
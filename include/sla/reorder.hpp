@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace sla {
+
+// (j["reorder"])
+struct ReorderStats
+{
+    std::uint64_t window{};
+    std::uint64_t reordered{};            // rows emitted earlier than they arrived
+    std::uint64_t duplicates_dropped{};   // exact copies of an already emitted row
+    std::uint64_t late_dropped{};         // arrived after the window had moved past their t
+};
+
+// Repairs out-of-order timestamps with O(window) memory: rows wait in a
+// min-heap keyed by (t_ms, arrival order) and leave it once more than
+// `window` rows are pending, so the output is sorted whenever no row is
+// displaced by more than `window` positions. Rows older than the last
+// emitted timestamp can't be placed any more and are dropped
+class ReorderBuffer
+{
+public:
+    using Row = std::array<double, 4>;
+    using Emit = std::function<void(const Row &)>;
+
+    ReorderBuffer(std::size_t window, bool drop_duplicates, Emit emit);
+
+    void push(const Row &row);
+
+    // Emits everything still pending (end of input)
+    void flush();
+
+    const ReorderStats &stats() const { return stats_; }
+
+private:
+    struct Pending
+    {
+        Row row;
+        std::uint64_t seq;
+        bool displaced;   // a later timestamp had already arrived
+    };
+
+    void pop_one();
+
+    std::size_t window_;
+    bool drop_duplicates_;
+    Emit emit_;
+
+    std::vector<Pending> heap_;
+    std::uint64_t seq_{0};
+    bool have_max_{false};
+    double max_t_seen_{0.0};
+
+    bool have_emitted_{false};
+    double last_emitted_t_{0.0};
+    std::vector<Row> emitted_at_last_t_;   // rows sharing last_emitted_t_ (at most window + 1)
+
+    ReorderStats stats_{};
+};
+
+}
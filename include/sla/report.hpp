@@ -1,12 +1,16 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <vector>
 
 #include "welford_stats.hpp"
 #include "time_axis.hpp"
+#include "reorder.hpp"
+#include "psd.hpp"
+#include "warning_summary.hpp"
 
 namespace sla {
 
@@ -14,7 +18,7 @@ namespace sla {
 struct Warning
 {
     std::string message;               // "invalid value", "incorrect number of columns ..." ...
-    std::size_t line{};
+    std::uint64_t line{};
     std::optional<std::size_t> column; // Can be text or “nothing”
     std::optional<std::string> value;  // Can be text or “nothing”
 };
@@ -22,13 +26,18 @@ struct Warning
 // (j["counts"])
 struct Counts
 {
-    std::size_t data_lines{};
-    std::size_t header_lines{};
-    std::size_t parsed_lines{};
-    std::size_t total_lines{};
-    std::size_t empty_lines{};
-    std::size_t comment_lines{};
-    std::size_t bad_lines{};
+    std::uint64_t data_lines{};
+    std::uint64_t header_lines{};
+    std::uint64_t parsed_lines{};
+    std::uint64_t total_lines{};
+    std::uint64_t empty_lines{};
+    std::uint64_t comment_lines{};
+    std::uint64_t bad_lines{};
+
+    // clean --hampel
+    std::uint64_t outliers{};               // values over the Hampel threshold
+    std::uint64_t outlier_rows_dropped{};
+    std::uint64_t outlier_values_replaced{};
 };
 
 // (j["statistics"]["ax"] ...)
@@ -47,7 +56,10 @@ struct Report
     std::vector<Warning> warnings{};
     TimeAxisReport time_axis{};
     ImuStatistics statistics{};
-    std::size_t warnings_dropped{};
+    std::uint64_t warnings_dropped{};
+    std::vector<WarningCategory> warning_categories{};
+    std::optional<ReorderStats> reorder{};   // clean --reorder-window only
+    std::optional<PsdReport> psd{};          // --psd only
 };
 
 }
@@ -2,7 +2,9 @@
 
 #include <filesystem>
 #include <nlohmann/json.hpp>
+#include <string>
 
+#include "json_writer.hpp"
 #include "report.hpp"
 
 namespace sla {
@@ -11,11 +13,15 @@ namespace sla {
 // Does NOT write to a file, only forms the JSON structure
 nlohmann::ordered_json report_to_json(const Report& r);
 
+// Same report streamed into w, no tree: report_json_text(r) == report_to_json(r).dump(4)
+void write_report_json(JsonWriter& w, const Report& r);
+std::string report_json_text(const Report& r);
+
 // Selects the path to the output .json based on input_path:
 // data/imu_dirty.csv -> data/imu_dirty.json
 std::filesystem::path default_report_json_path(const std::filesystem::path& input_path);
 
-// Writes report_to_json(r) to the output_path file (with indentation)
+// Writes report_json_text(r) to the output_path file, "-" = stdout
 // Throws std::runtime_error if the file cannot be opened
 void write_report_json_file(const Report& r, const std::filesystem::path& output_path);
 
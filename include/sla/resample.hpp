@@ -0,0 +1,84 @@
+#pragma once
+
+#include "report.hpp"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+
+namespace sla {
+
+enum class ResampleKernel { Linear, Nearest };
+
+// What happens to grid points that fall into an input gap (dt > max_gap_ms)
+enum class GapPolicy
+{
+    Fill,    // interpolate across the gap like anywhere else
+    Split    // write no rows inside the gap; the grid resumes after it
+};
+
+bool parse_resample_kernel(std::string_view s, ResampleKernel &out);
+bool parse_gap_policy(std::string_view s, GapPolicy &out);
+
+struct ResampleOptions
+{
+    std::filesystem::path input_path;     // "-" = stdin
+    std::filesystem::path output_path;    // "-" = stdout
+
+    double rate_hz{1000.0};
+    ResampleKernel kernel{ResampleKernel::Linear};
+    GapPolicy gap_policy{GapPolicy::Fill};
+    double max_gap_ms{0.0};               // 0 = no gap handling
+};
+
+struct ResampleResult
+{
+    bool ok{true};
+    std::string error;
+
+    std::string input_name;
+    Counts counts{};                      // of the input, as in analyze
+
+    std::uint64_t rows_out{};
+    std::uint64_t gaps{};                 // input intervals longer than max_gap_ms
+    std::uint64_t grid_points_skipped{};  // inside gaps (GapPolicy::Split)
+    std::uint64_t rows_skipped{};         // t_ms not increasing; run clean --reorder-window first
+};
+
+// Streams rows onto the grid t = k * 1000 / rate_hz, starting at the first
+// grid point not before the first sample (same grid for every file).
+// Each grid point is interpolated from the two input rows around it,
+// so memory doesn't depend on the file size
+class Resampler
+{
+public:
+    using Row = std::array<double, 4>;
+    using Emit = std::function<void(const Row &)>;
+
+    // opt and res must outlive the Resampler; counters go to res
+    Resampler(const ResampleOptions &opt, ResampleResult &res, Emit emit);
+
+    // Emits every grid point up to row's timestamp
+    void push(const Row &row);
+
+private:
+    Row interpolate(double t, const Row &a, const Row &b) const;
+
+    const ResampleOptions &opt_;
+    ResampleResult &res_;
+    Emit emit_;
+    double period_ms_;
+
+    bool have_prev_{false};
+    Row prev_{};
+    std::int64_t k_{0};     // next grid index
+};
+
+// Reads opt.input_path once and writes the resampled CSV to opt.output_path
+ResampleResult run_resample(const ResampleOptions &opt);
+
+}
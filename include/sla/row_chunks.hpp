@@ -0,0 +1,74 @@
+#pragma once
+
+#include "calibration.hpp"
+#include "doubling_chunks.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace sla {
+
+// ax/ay/az sums of one chunk and the byte offset of its first row
+struct RowChunk
+{
+    Vec3 sum;
+    std::uint64_t byte_offset{};
+
+    // merging keeps the first offset
+    void add(const RowChunk &next)
+    {
+        sum = {sum.x + next.sum.x, sum.y + next.sum.y, sum.z + next.sum.z};
+    }
+};
+
+// ax/ay/az sums of a capture in DoublingChunks (~2 MB); the chunk offsets let
+// rows that don't fill a whole chunk be re-read later
+class RowChunkSums
+{
+public:
+    static constexpr std::size_t DEFAULT_MAX_CHUNKS = std::size_t{1} << 16;
+
+    explicit RowChunkSums(std::size_t max_chunks = DEFAULT_MAX_CHUNKS);
+
+    // row as parsed, byte_offset of its line (RowLocation::byte_offset)
+    void add(const std::array<double, 4> &row, std::uint64_t byte_offset);
+
+    // Closes the last, partial chunk; call once after the last add()
+    void finish();
+
+    std::uint64_t rows() const { return chunks_.rows(); }
+    std::uint64_t chunk_rows() const { return chunks_.chunk_rows(); }
+    std::size_t chunks() const { return chunks_.chunks().size(); }
+
+    // Chunk i holds rows [i * chunk_rows(), min((i + 1) * chunk_rows(), rows()))
+    const Vec3 &sum(std::size_t i) const { return chunks_.chunks()[i].sum; }
+    std::uint64_t byte_offset(std::size_t i) const { return chunks_.chunks()[i].byte_offset; }
+
+private:
+    DoublingChunks<RowChunk> chunks_;
+};
+
+// Rows [begin, end) counted into target
+struct RowRange
+{
+    std::uint64_t begin{};
+    std::uint64_t end{};
+    std::size_t target{};
+};
+
+// Per-target sums and row counts over any number of row ranges (several may
+// share a target): whole chunks come from the chunk sums, the partial ones
+// at range edges are re-read. Uncompressed files are read chunk by chunk at
+// the recorded offsets; compressed inputs can't seek, they get one more
+// sequential read that only looks at the edge chunks. sum and n are resized
+// to `targets`. On failure sets error
+bool sum_row_ranges(const std::filesystem::path &input, const RowChunkSums &chunks,
+                    const std::vector<RowRange> &ranges, std::size_t targets,
+                    std::vector<Vec3> &sum, std::vector<std::uint64_t> &n, std::string &error);
+
+}
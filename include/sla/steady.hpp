@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace sla {
+
+struct SteadyOptions
+{
+    std::size_t window{0};        // rows in the rolling window; 0 = off
+    double threshold{0.05};       // still if the window's accel std (m/s^2, all axes) is at most this
+    std::uint64_t min_rows{0};    // shorter segments are ignored; 0 = 2 * window
+    double max_angle_deg{15.0};   // segment mean vs expected gravity direction when matching
+    bool cluster{false};          // match by direction (cluster_steady_segments), not in capture order
+};
+
+// A run of rows [begin, end) whose every window was still
+struct SteadySegment
+{
+    std::uint64_t begin{};
+    std::uint64_t end{};
+    std::array<double, 3> mean{};   // ax, ay, az
+};
+
+// Streaming stationarity detector: a rolling window of `window` rows keeps
+// the per-axis sum and sum of squares (relative to the first row, so the
+// variance doesn't cancel against g^2). A window is still when the summed
+// per-axis variance is under threshold^2 - unlike the variance of |a| this
+// also catches a slow turntable rotation, where |a| stays at g.
+// Overlapping still windows form one segment. O(1) per row
+class SteadySegmenter
+{
+public:
+    explicit SteadySegmenter(const SteadyOptions &opt);
+
+    void push(double ax, double ay, double az);
+
+    // Closes the segment still open at the end of the input
+    void finish();
+
+    const std::vector<SteadySegment> &segments() const { return segments_; }
+
+private:
+    void close(std::uint64_t end);
+
+    std::size_t window_;
+    double var_limit_;
+    std::uint64_t min_rows_;
+
+    std::vector<std::array<double, 3>> ring_;
+    std::array<double, 3> ref_{};
+    std::array<double, 3> sum_{};
+    std::array<double, 3> sum_sq_{};
+    std::uint64_t rows_{0};
+
+    bool open_{false};
+    std::uint64_t begin_{0};
+    std::uint64_t last_end_{0};
+    std::array<double, 3> seg_sum_{};
+
+    std::vector<SteadySegment> segments_;
+};
+
+// Assigns segments to positions in capture order: each position gets one or
+// more consecutive segments within max_angle_deg of its expected gravity
+// direction, other segments (transitions, rest before/after) are skipped.
+// Among valid assignments the one covering the most rows wins (O(S * P) DP).
+// Returns the position index per segment (-1 = unused), or {} if some
+// position can't be matched
+std::vector<int> match_steady_segments(
+    const std::vector<SteadySegment> &segments,
+    const std::vector<std::array<double, 3>> &expected,
+    double max_angle_deg);
+
+// Order-free alternative for captures whose position order is unknown or
+// whose dwells are uneven: spherical k-means on the segments' mean gravity
+// directions, weighted by segment rows, with one cluster per distinct
+// expected direction, seeded from it - so a cluster keeps its positions.
+// Works on the segment summaries only (O(S * P) per iteration). Segments
+// ending up more than max_angle_deg from their cluster's direction are left
+// unused. Positions with the same direction (e.g. inner 0 and 90 at outer 0)
+// share a cluster; its segments are dealt to them in capture order, which
+// doesn't change the fit since they have the same reference gravity.
+// Returns the position per segment (-1 = unused), or {} if a position gets
+// no segment or two different expected directions are within max_angle_deg
+std::vector<int> cluster_steady_segments(
+    const std::vector<SteadySegment> &segments,
+    const std::vector<std::array<double, 3>> &expected,
+    double max_angle_deg);
+
+}
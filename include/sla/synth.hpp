@@ -0,0 +1,107 @@
+#pragma once
+
+#include "calibration.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace sla {
+
+// Deterministic synthetic IMU capture (same seed -> same bytes)
+struct SynthOptions
+{
+    std::uint64_t rows{100000};     // parsed rows; malformed lines come on top
+    double rate_hz{100.0};
+    std::uint64_t seed{1};
+
+    // time axis defects
+    double jitter_ms{0.0};          // uniform +-jitter_ms on every timestamp
+    double gap_ratio{0.0};          // probability that a sample follows a gap
+    double gap_ms{100.0};           // length of one gap
+    double duplicate_ratio{0.0};    // probability that t repeats the previous t
+    double out_of_order_ratio{0.0}; // probability that t steps back by half a period
+
+    // line defects
+    double malformed_ratio{0.0};    // probability of an unparseable line before a row
+
+    // signal
+    double gravity{9.81054};
+    double noise{0.01};             // uniform +-noise on every axis
+
+    // Calibration capture: rows are split into positions.size() equal blocks
+    // in POSITION.txt order. Empty -> the sensor stays in position (0, 0)
+    std::vector<Position> positions;
+    double transition_frac{0.2};    // leading part of each block spent rotating
+
+    // Measurement model a_meas = M*a_true + b (roughly the sensor in data_calib.json)
+    Mat3 M{{{1.01, 0.0015, -0.0016},
+            {-0.00026, 0.98, -0.00006},
+            {0.00073, 0.00012, 1.03}}};
+    Vec3 b{-0.3, 0.2, 0.1};
+};
+
+// splitmix64: tiny, fast and identical on every platform (unlike <random> distributions)
+class SplitMix64
+{
+public:
+    explicit SplitMix64(std::uint64_t seed) : state_(seed) {}
+
+    std::uint64_t next()
+    {
+        std::uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // [0, 1)
+    double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+    // [-a, a)
+    double symmetric(double a) { return (2.0 * uniform() - 1.0) * a; }
+
+private:
+    std::uint64_t state_;
+};
+
+// Row source: yields opt.rows rows {t_ms, ax, ay, az} without touching the disk
+class SynthImuSource
+{
+public:
+    explicit SynthImuSource(const SynthOptions &opt);
+
+    // false when all rows were produced
+    bool next(std::array<double, 4> &row);
+
+    std::uint64_t produced() const { return i_; }
+
+private:
+    Vec3 true_gravity(std::uint64_t i, bool &rotating) const;
+
+    SynthOptions opt_;
+    SplitMix64 rng_;
+    std::vector<Vec3> block_g_;     // gravity_true per position (one entry if none)
+    double period_ms_{};
+    double gap_offset_ms_{};
+    double last_t_{};
+    std::uint64_t i_{0};
+};
+
+struct SynthResult
+{
+    bool ok{true};
+    std::string error;
+
+    std::uint64_t rows{};
+    std::uint64_t malformed_lines{};
+    std::uint64_t bytes{};
+};
+
+// Streams a synthetic capture (header + rows + malformed lines) to out_path
+SynthResult write_synthetic_csv(const SynthOptions &opt, const std::filesystem::path &out_path);
+
+}
@@ -2,7 +2,10 @@
 
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <string_view>
+#include <vector>
 
 #include "welford_stats.hpp"
 
@@ -12,17 +15,118 @@ namespace sla{
 
 struct TimeAxisIssues
 {
-    size_t non_increasing{};
-    size_t duplicates{};
-    size_t gaps{};
+    std::uint64_t non_increasing{};
+    std::uint64_t duplicates{};
+    std::uint64_t gaps{};
+};
+
+enum class TimeAxisEventKind : std::uint8_t { NonIncreasing, Duplicate, Gap };
+
+std::string_view to_string(TimeAxisEventKind kind);
+
+// One anomaly, or a run of the same anomaly on consecutive rows
+// (e.g. a burst of duplicated timestamps). Location is that of the first row
+// of the run; t_before is the timestamp just before it, t_after the last one
+// of the run, dt = t_after - t_before
+struct TimeAxisEvent
+{
+    TimeAxisEventKind kind{};
+    std::uint64_t row{};           // 0-based index among parsed rows
+    std::uint64_t line{};          // 1-based input line, 0 if unknown
+    std::uint64_t byte_offset{};
+    double t_before{};
+    double t_after{};
+    double dt{};
+    std::uint64_t count{1};        // rows in the run
+};
+
+// Streaming dt histogram with log-spaced buckets: 32 per octave (~2% wide)
+// over [2^-20, 2^30) ms, values outside are clamped into the end buckets.
+// Each bucket keeps its count and the smallest/largest dt it got. A quantile
+// is interpolated by rank between that min and max, i.e. the values of a
+// bucket are taken as evenly spread: exact when they are all equal (a clean
+// clock), and for a smooth dt distribution (jitter) the error is a small
+// fraction of the bucket width - never more than that width
+class DtHistogram
+{
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr int MIN_EXP = -20;
+    static constexpr int MAX_EXP = 30;
+    static constexpr std::size_t BUCKETS = std::size_t(MAX_EXP - MIN_EXP) << SUB_BITS;
+
+    DtHistogram() : counts_(BUCKETS), mins_(BUCKETS), maxs_(BUCKETS) {}
+
+    // dt > 0 only
+    void add(double dt);
+
+    std::uint64_t count() const { return total_; }
+
+    // 0 <= q <= 1; 0.0 if empty
+    double quantile(double q) const;
+    double median() const { return quantile(0.5); }
+
+    // Peak of the dt density: in the most populated bucket, placed from the
+    // densities of its neighbours (grouped-data mode); 0.0 if empty
+    double mode() const;
+
+    static std::size_t bucket_index(double dt);
+
+    // [bucket_lower(i), bucket_lower(i + 1)) is bucket i
+    static double bucket_lower(std::size_t i);
+
+private:
+    double density(std::size_t i) const;
+
+    std::vector<std::uint64_t> counts_;
+    std::vector<double> mins_;
+    std::vector<double> maxs_;
+    std::uint64_t total_{0};
 };
 
 struct TimeAxisReport
 {
     bool dt_available{};
     Stats dt_ms{};
-    double sampling_hz_est{};
+    double dt_median_ms{};
+    double dt_mode_ms{};
+    double sampling_hz_est{};       // 1000 / median dt
     TimeAxisIssues anomalies{};
+
+    std::vector<TimeAxisEvent> events{};
+    std::uint64_t events_dropped{};   // anomalies not recorded once events was full
+};
+
+// Single-pass time axis analysis: update(t) for every timestamp in file order,
+// then report(). Needs no second look at the data, so it works on pipes.
+// A gap is dt > 2 * median(dt) of the samples seen before it; the median is
+// re-read from the histogram at dt counts 1, 2, 4, ... and then every 1024 dts
+class TimeAxisAccumulator
+{
+public:
+    static constexpr std::size_t DEFAULT_MAX_EVENTS = 1000;
+
+    explicit TimeAxisAccumulator(std::size_t max_events = DEFAULT_MAX_EVENTS) : max_events_(max_events) {}
+
+    // line/byte_offset only locate events; pass 0 when unknown
+    void update(double t, std::uint64_t line = 0, std::uint64_t byte_offset = 0);
+    TimeAxisReport report() const;
+
+private:
+    void record(TimeAxisEventKind kind, double t, double dt, std::uint64_t line, std::uint64_t byte_offset);
+
+    WelfordStats dt_stats_;
+    DtHistogram dt_hist_;
+    double median_dt_{0.0};      // reference for gap detection
+    TimeAxisIssues anomalies_{};
+    bool have_last_{false};
+    double last_{0.0};
+    std::uint64_t row_{0};
+
+    std::size_t max_events_;
+    std::vector<TimeAxisEvent> events_;
+    std::uint64_t events_dropped_{0};
+    std::uint64_t last_event_row_{0};   // last row folded into events_.back()
 };
 
 // function that takes a single timestamp
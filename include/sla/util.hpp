@@ -1,8 +1,21 @@
 #pragma once
+#include <cstddef>
+#include <string>
 #include <string_view>
 
 namespace sla {
 
 std::string_view trim(std::string_view s);
 
-}
\ No newline at end of file
+// Length of the well-formed UTF-8 sequence starting at s[i] (RFC 3629: no
+// overlongs, surrogates or code points above U+10FFFF), 0 if there is none
+std::size_t utf8_sequence_length(std::string_view s, std::size_t i);
+
+// U+FFFD, what invalid UTF-8 bytes become in report text
+inline constexpr std::string_view UTF8_REPLACEMENT = "\xEF\xBF\xBD";
+
+// s with every byte that isn't part of a well-formed sequence replaced by
+// U+FFFD, so it can go into the JSON report
+std::string to_valid_utf8(std::string_view s);
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace sla {
+
+enum class WarningKind : std::uint8_t
+{
+    ColumnCount,    // line doesn't split into 4 columns
+    InvalidValue,   // a column isn't a number
+};
+
+// Column counts from here up share one category ("got 32 or more")
+inline constexpr std::size_t WARNING_MAX_COLUMNS = 32;
+
+// Interned message of a bad line: "invalid value" or
+// "incorrect number of columns (expected 4, got 3)"; detail as in WarningCategory
+std::string_view warning_message(WarningKind kind, std::size_t detail);
+
+// Examples kept per category, and bytes kept of each example's text
+inline constexpr std::size_t WARNING_SAMPLES = 8;
+inline constexpr std::size_t WARNING_TEXT_MAX = 40;
+
+// One example line of a category. text is the offending token (invalid
+// value) or the start of the line (column count), cut at a UTF-8 boundary;
+// bytes that aren't valid UTF-8 are replaced by U+FFFD
+struct WarningSample
+{
+    std::uint64_t line{};
+    std::uint8_t text_size{};
+    bool truncated{false};
+    std::array<char, WARNING_TEXT_MAX> text_buf{};
+
+    std::string_view text() const { return {text_buf.data(), text_size}; }
+};
+
+// (j["warning_categories"][i])
+struct WarningCategory
+{
+    WarningKind kind{};
+    std::size_t detail{};        // ColumnCount: columns found (capped); InvalidValue: 1-based column
+    std::uint64_t count{};
+    std::uint64_t first_line{};
+    std::uint64_t last_line{};
+
+    std::array<WarningSample, WARNING_SAMPLES> samples{};
+    std::size_t sample_count{};  // min(count, WARNING_SAMPLES)
+
+    std::string_view message() const { return warning_message(kind, detail); }
+};
+
+// Per-category counts of bad lines with a reservoir sample of example lines
+// spread over the whole input (Algorithm R, fixed seed so reports are
+// reproducible). Memory is bounded by the number of categories; after a
+// category's first line, add() doesn't allocate
+class WarningSummary
+{
+public:
+    void add(WarningKind kind, std::size_t detail, std::uint64_t line, std::string_view text);
+
+    // Categories by (kind, detail), samples by line; the summary is left empty
+    std::vector<WarningCategory> take();
+
+private:
+    std::uint64_t next_random();
+
+    std::vector<WarningCategory> categories_;
+    std::uint64_t rng_state_{0x9e3779b97f4a7c15ull};
+};
+
+}
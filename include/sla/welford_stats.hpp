@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <cmath>
 #include <limits>
 
@@ -9,7 +10,7 @@ namespace sla{
 
 struct Stats
 {
-    int count{};
+    std::uint64_t count{};
     double min{};
     double max{};
     double mean{};
@@ -19,7 +20,7 @@ struct Stats
 
 class WelfordStats{
 private:
-    std::size_t count_;
+    std::uint64_t count_;
     double mean_;
     double M2_;
     double min_;
@@ -54,7 +55,7 @@ public:
         M2_ += delta * delta2;
     }
 
-    std::size_t count() const { return count_; }
+    std::uint64_t count() const { return count_; }
     double mean() const { return mean_; }
 
     double min() const {
@@ -67,7 +68,7 @@ public:
 
     // sample variance (with Bessel correction)
     double variance () const{
-        return (count_ > 1) ? M2_ / (count_ - 1) : 0.0;
+        return (count_ > 1) ? M2_ / static_cast<double>(count_ - 1) : 0.0;
     }
 
     double stddev() const { return std::sqrt(variance()); }
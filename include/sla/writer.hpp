@@ -1,28 +1,83 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <filesystem>
-#include <fstream>
 #include <string_view>
+#include <vector>
 
 namespace sla {
 
-//  data/imu_dirty.csv -> data/imu_dirty_clean.csv
+//  data/imu_dirty.csv.gz -> data/imu_dirty.csv (also .zst). Outputs are
+//  written uncompressed, so they're named after the decompressed file
+std::filesystem::path strip_compression_extension(const std::filesystem::path &input);
+
+//  data/imu_dirty.csv -> data/imu_dirty_clean.csv, data/imu_dirty.csv.gz too
 std::filesystem::path make_clean_path(const std::filesystem::path &input);
 
 std::filesystem::path make_calib_path(const std::filesystem::path &input);
 
+//  data/imu_dirty.csv -> data/imu_dirty_resampled.csv
+std::filesystem::path make_resample_path(const std::filesystem::path &input);
+
+// Raw byte sink with a large user-space buffer: one fwrite per `capacity` bytes.
+// Used where ofstream formatting is the bottleneck (e.g. `sla gen`)
+class BufferedWriter {
+public:
+    explicit BufferedWriter(std::size_t capacity = std::size_t{1} << 20);
+    ~BufferedWriter();
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    // "-" writes to stdout
+    bool open(const std::filesystem::path &out_path);
+    bool is_open() const { return file_ != nullptr; }
+
+    void write(std::string_view s);
+    void write_char(char c);
+
+    // Shortest representation that round-trips (std::to_chars)
+    void write_double(double v);
+
+    // printf("%.<precision>g") formatting, without the locale and iostream overhead
+    void write_double(double v, int precision);
+
+    // false once any fwrite/fclose has failed
+    bool ok() const { return ok_; }
+
+    std::uint64_t bytes_written() const { return bytes_ + used_; }
+
+    void flush();
+    void close();
+
+private:
+    void reserve(std::size_t n);
+
+    std::FILE *file_{nullptr};
+    bool owned_{false};            // false for stdout
+    std::vector<char> buf_;
+    std::size_t used_{0};
+    std::uint64_t bytes_{0};
+    bool ok_{true};
+};
+
 // Class that encapsulates the entire clean CSV record
 class CsvWriter {
 public:
     CsvWriter() = default;
 
-    // Open file for writing
+    // Open file for writing ("-" = stdout)
     bool open(const std::filesystem::path &out_path);
 
     // Is the file open
     bool is_open() const { return out_.is_open(); }
 
+    // false once a write has failed (disk full, closed pipe...)
+    bool ok() const { return out_.ok(); }
+
     // Path to the open file (to display a message to the user)
     const std::filesystem::path& path() const { return path_; }
 
@@ -37,9 +92,9 @@ public:
 
 private:
 
-    // Type: output file stream
-    // Purpose: stores an open file
-    std::ofstream out_;
+    // Type: buffered byte sink
+    // Purpose: stores an open file (or stdout)
+    BufferedWriter out_;
 
     // Type: path to file
     // Purpose: remembers where we write
@@ -0,0 +1,210 @@
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+
+# Every case: command + files it produces (relative to the work dir)
+CASES = {
+    "analyze": {
+        "input": "perf_dirty.csv",
+        "args": ["analyze"],
+        "outputs": ["perf_dirty.json"],
+    },
+    "clean": {
+        "input": "perf_dirty.csv",
+        "args": ["clean"],
+        "outputs": ["perf_dirty.json", "perf_dirty_clean.csv"],
+    },
+    "calib": {
+        "input": "perf_calib.csv",
+        "args": ["calib"],
+        "outputs": ["perf_calib_calib.csv", "perf_calib_calib.json"],
+    },
+}
+
+
+def read_vm_hwm_kb(pid: int) -> int:
+    """VmHWM of a live process in KiB, 0 once it has exited."""
+    try:
+        with open(f"/proc/{pid}/status", encoding="ascii") as f:
+            for line in f:
+                if line.startswith("VmHWM:"):
+                    return int(line.split()[1])
+    except (FileNotFoundError, ProcessLookupError):
+        pass
+    return 0
+
+
+def run_measured(cmd: list[str], cwd: Path) -> tuple[float, int]:
+    """Runs cmd, returns (wall seconds, peak RSS in KiB) of that child only.
+
+    ru_maxrss can't be used on Linux: a child forked from this script starts
+    with the script's RSS as its high-water mark and keeps it across exec, so
+    every case would report the Python process. VmHWM in /proc/<pid>/status
+    belongs to the address space exec created, i.e. to sla alone; it's a
+    high-water mark, so sampling it until the child exits loses nothing but
+    growth in the last poll interval.
+    """
+    # stderr goes to a file: nothing reads a pipe while we poll, so a chatty
+    # child would block on a full pipe buffer
+    with tempfile.TemporaryFile() as err:
+        t0 = time.perf_counter()
+        proc = subprocess.Popen(cmd, cwd=cwd, stdout=subprocess.DEVNULL, stderr=err)
+
+        on_linux = platform.system() == "Linux"
+        peak_kb = 0
+        while True:
+            if on_linux:
+                peak_kb = max(peak_kb, read_vm_hwm_kb(proc.pid))
+
+            pid, status, usage = os.wait4(proc.pid, os.WNOHANG)
+            if pid != 0:
+                break
+            time.sleep(0.002)
+        elapsed = time.perf_counter() - t0
+
+        # Popen doesn't know we reaped it
+        proc.returncode = os.waitstatus_to_exitcode(status)
+        if proc.returncode != 0:
+            err.seek(0)
+            stderr = err.read().decode(errors="replace")
+            raise RuntimeError(f"{' '.join(cmd)} failed ({proc.returncode}):\n{stderr}")
+
+    if not on_linux:
+        # no /proc: ru_maxrss (bytes on macOS), which includes what fork inherited
+        peak_kb = usage.ru_maxrss // 1024 if platform.system() == "Darwin" else usage.ru_maxrss
+    elif peak_kb == 0:
+        raise RuntimeError(f"{' '.join(cmd)} exited before its memory could be sampled")
+
+    return elapsed, int(peak_kb)
+
+
+def generate_inputs(sla: Path, work: Path, rows: int, seed: int, position: Path) -> None:
+    dirty = work / "perf_dirty.csv"
+    calib = work / "perf_calib.csv"
+    stamp = work / "inputs.json"
+
+    wanted = {"rows": rows, "seed": seed}
+    if stamp.exists() and dirty.exists() and calib.exists():
+        if json.loads(stamp.read_text(encoding="utf-8")) == wanted:
+            return
+
+    common = ["--rows", str(rows), "--seed", str(seed)]
+    subprocess.run([str(sla), "gen", "--output", str(dirty), *common,
+                    "--jitter", "0.3", "--gap-ratio", "0.0005", "--dup-ratio", "0.0005",
+                    "--ooo-ratio", "0.0005", "--bad-ratio", "0.001"],
+                   check=True, stdout=subprocess.DEVNULL)
+    subprocess.run([str(sla), "gen", "--output", str(calib), *common,
+                    "--position", str(position)],
+                   check=True, stdout=subprocess.DEVNULL)
+
+    # calib looks for POSITION.txt next to its input
+    shutil.copyfile(position, work / "POSITION.txt")
+    stamp.write_text(json.dumps(wanted), encoding="utf-8")
+
+
+def measure(sla: Path, work: Path, rows: int, repeat: int) -> dict[str, dict[str, float]]:
+    results: dict[str, dict[str, float]] = {}
+
+    for name, case in CASES.items():
+        best_time = float("inf")
+        peak_rss = 0
+        for _ in range(repeat):
+            cmd = [str(sla), *case["args"], "--input", case["input"]]
+            elapsed, rss = run_measured(cmd, work)
+            best_time = min(best_time, elapsed)
+            peak_rss = max(peak_rss, rss)
+
+        out_bytes = sum((work / f).stat().st_size for f in case["outputs"])
+        results[name] = {
+            "rows_per_s": rows / best_time,
+            "seconds": best_time,
+            "peak_rss_kb": peak_rss,
+            "output_bytes": out_bytes,
+        }
+
+    return results
+
+
+def compare(results: dict, baseline: dict, tolerance: float) -> list[str]:
+    failures = []
+
+    for name, cur in results.items():
+        base = baseline.get(name)
+        if base is None:
+            failures.append(f"{name}: no baseline (run with --update)")
+            continue
+
+        if cur["rows_per_s"] < base["rows_per_s"] * (1.0 - tolerance):
+            failures.append(f"{name}: rows/s {cur['rows_per_s']:.0f} < baseline {base['rows_per_s']:.0f}")
+
+        if cur["peak_rss_kb"] > base["peak_rss_kb"] * (1.0 + tolerance):
+            failures.append(f"{name}: peak RSS {cur['peak_rss_kb']} KiB > baseline {base['peak_rss_kb']} KiB")
+
+        # outputs are deterministic: any size change is a behaviour change
+        if cur["output_bytes"] != base["output_bytes"]:
+            failures.append(f"{name}: output bytes {cur['output_bytes']} vs baseline {base['output_bytes']}")
+
+    return failures
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="End-to-end perf regression check for sla analyze/clean/calib.")
+    ap.add_argument("--sla", type=Path, required=True, help="Path to the sla executable")
+    ap.add_argument("--baseline", type=Path, required=True, help="Checked-in baseline JSON")
+    ap.add_argument("--work-dir", type=Path, required=True, help="Where generated inputs and outputs go")
+    ap.add_argument("--position", type=Path, required=True, help="POSITION.txt for the calib capture")
+    ap.add_argument("--rows", type=int, default=2_000_000, help="Rows per generated capture (default: 2000000)")
+    ap.add_argument("--seed", type=int, default=1, help="Generator seed (default: 1)")
+    ap.add_argument("--repeat", type=int, default=3, help="Runs per case; best time is kept (default: 3)")
+    ap.add_argument("--tolerance", type=float, default=0.25,
+                    help="Allowed relative regression of rows/s and peak RSS (default: 0.25); "
+                         "output bytes must match exactly")
+    ap.add_argument("--update", action="store_true", help="Record the current numbers as the new baseline")
+    args = ap.parse_args()
+
+    args.work_dir.mkdir(parents=True, exist_ok=True)
+    generate_inputs(args.sla, args.work_dir, args.rows, args.seed, args.position)
+
+    results = measure(args.sla, args.work_dir, args.rows, args.repeat)
+    (args.work_dir / "perf_results.json").write_text(json.dumps(results, indent=4), encoding="utf-8")
+
+    for name, r in results.items():
+        print(f"{name:8s} {r['rows_per_s']:>14,.0f} rows/s  {r['peak_rss_kb']:>9} KiB  {r['output_bytes']:>12} B")
+
+    config = {"rows": args.rows, "seed": args.seed}
+
+    if args.update:
+        args.baseline.write_text(json.dumps({"config": config, "cases": results}, indent=4) + "\n",
+                                 encoding="utf-8")
+        print(f"Baseline written to: {args.baseline}")
+        return 0
+
+    if not args.baseline.exists():
+        print(f"Error: baseline not found: {args.baseline} (run with --update)", file=sys.stderr)
+        return 1
+
+    baseline = json.loads(args.baseline.read_text(encoding="utf-8"))
+    if baseline.get("config") != config:
+        print(f"Error: baseline was recorded with {baseline.get('config')}, this run uses {config}",
+              file=sys.stderr)
+        return 1
+
+    failures = compare(results, baseline["cases"], args.tolerance)
+    for f in failures:
+        print(f"REGRESSION {f}", file=sys.stderr)
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
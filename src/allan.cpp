@@ -0,0 +1,225 @@
+#include "sla/allan.hpp"
+#include "sla/input_source.hpp"   // is_stdio_path
+#include "sla/time_axis.hpp"
+#include "sla/writer.hpp"
+#include "sla/csv.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+
+namespace sla
+{
+
+    std::vector<std::uint64_t> allan_cluster_sizes(std::uint64_t n, int points_per_decade)
+    {
+        std::vector<std::uint64_t> out;
+        if (n < 3 || points_per_decade <= 0)
+            return out;
+
+        const std::uint64_t m_max = (n - 1) / 2;
+        for (int i = 0;; ++i)
+        {
+            const auto m = static_cast<std::uint64_t>(std::floor(std::pow(10.0, double(i) / points_per_decade)));
+            if (m > m_max)
+                break;
+            if (out.empty() || m != out.back())
+                out.push_back(m);
+        }
+        return out;
+    }
+
+    double overlapping_adev(const std::vector<double> &cum, std::uint64_t m)
+    {
+        if (cum.empty() || m == 0 || cum.size() <= 2 * m)
+            return 0.0;
+
+        const std::uint64_t n = cum.size() - 1;
+
+        const std::uint64_t terms = n + 1 - 2 * m;
+        const double *c = cum.data();
+
+        double acc = 0.0;
+        for (std::uint64_t k = 0; k < terms; ++k)
+        {
+            const double d = c[k + 2 * m] - 2.0 * c[k + m] + c[k];
+            acc += d * d;
+        }
+
+        const double md = static_cast<double>(m);
+        return std::sqrt(acc / (2.0 * md * md * static_cast<double>(terms)));
+    }
+
+    std::filesystem::path make_allan_path(const std::filesystem::path &input)
+    {
+        const auto plain = strip_compression_extension(input);
+        return plain.parent_path() / (plain.stem().string() + "_allan.json");
+    }
+
+    AllanResult run_allan(const AllanOptions &opt)
+    {
+        AllanResult res;
+
+        // Prefix sums of (value - first value): the offset is a linear term in
+        // cum and cancels in the second difference, but keeping it out stops
+        // the sums from growing to N * 9.81 and eating the noise digits
+        std::array<std::vector<double>, 3> cum;
+        std::array<double, 3> offset{};
+        std::array<double, 3> run{};
+        TimeAxisAccumulator time_axis;
+
+        for (auto &c : cum)
+            c.push_back(0.0);
+
+        auto in = read_imu_csv_streaming(opt.input_path,
+        [&](const std::array<double, 4> &row)
+        {
+            time_axis.update(row[0]);
+
+            if (cum[0].size() == 1)
+                offset = {row[1], row[2], row[3]};
+
+            for (int a = 0; a < 3; ++a)
+            {
+                run[a] += row[a + 1] - offset[a];
+                cum[a].push_back(run[a]);
+            }
+        });
+
+        res.input_name = in.input_name;
+        res.counts = in.counts;
+
+        if (!in.ok)
+        {
+            res.ok = false;
+            res.error = in.error;
+            return res;
+        }
+
+        const auto ta = time_axis.report();
+        if (!ta.dt_available || cum[0].size() < 4)
+        {
+            res.ok = false;
+            res.error = "need at least 3 rows with increasing t_ms";
+            return res;
+        }
+        res.tau0_s = ta.dt_median_ms / 1000.0;
+
+        const std::uint64_t n = cum[0].size() - 1;
+        const auto ms = allan_cluster_sizes(n, opt.points_per_decade);
+        res.points.resize(ms.size());
+
+        // every tau is an O(N) sweep; threads take the next tau until none are left
+        std::atomic<std::size_t> next{0};
+        auto worker = [&]()
+        {
+            for (std::size_t i = next++; i < ms.size(); i = next++)
+            {
+                auto &p = res.points[i];
+                p.m = ms[i];
+                p.tau_s = static_cast<double>(ms[i]) * res.tau0_s;
+                p.terms = n + 1 - 2 * ms[i];
+                for (int a = 0; a < 3; ++a)
+                    p.adev[a] = overlapping_adev(cum[a], ms[i]);
+            }
+        };
+
+        unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(ms.size(), 1)));
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (auto &t : pool)
+            t.join();
+
+        return res;
+    }
+
+    static bool write_allan_csv(const AllanResult &r, const std::filesystem::path &path, std::string &error)
+    {
+        BufferedWriter out;
+        if (!out.open(path))
+        {
+            error = "can't open file for writing: " + path.string();
+            return false;
+        }
+
+        out.write("tau_s,m,terms,adev_ax,adev_ay,adev_az\n");
+        for (const auto &p : r.points)
+        {
+            out.write_double(p.tau_s);
+            out.write_char(',');
+            out.write(std::to_string(p.m));
+            out.write_char(',');
+            out.write(std::to_string(p.terms));
+            for (double v : p.adev)
+            {
+                out.write_char(',');
+                out.write_double(v);
+            }
+            out.write_char('\n');
+        }
+        out.close();
+
+        if (!out.ok())
+            error = "write failed: " + path.string();
+        return out.ok();
+    }
+
+    bool write_allan_result(const AllanResult &r, const std::filesystem::path &output_path, std::string &error)
+    {
+        if (output_path.extension() == ".csv")
+            return write_allan_csv(r, output_path, error);
+
+        nlohmann::ordered_json j;
+        j["input"] = r.input_name;
+        j["parsed_lines"] = r.counts.parsed_lines;
+        j["tau0_s"] = r.tau0_s;
+
+        nlohmann::ordered_json taus = nlohmann::ordered_json::array();
+        nlohmann::ordered_json m = nlohmann::ordered_json::array();
+        for (const auto &p : r.points)
+        {
+            taus.push_back(p.tau_s);
+            m.push_back(p.m);
+        }
+        j["tau_s"] = std::move(taus);
+        j["m"] = std::move(m);
+
+        const char *axes[3] = {"ax", "ay", "az"};
+        nlohmann::ordered_json adev;
+        for (int a = 0; a < 3; ++a)
+        {
+            nlohmann::ordered_json col = nlohmann::ordered_json::array();
+            for (const auto &p : r.points)
+                col.push_back(p.adev[a]);
+            adev[axes[a]] = std::move(col);
+        }
+        j["adev"] = std::move(adev);
+
+        if (is_stdio_path(output_path))
+        {
+            std::cout << j.dump(4) << '\n';
+            return true;
+        }
+
+        std::ofstream f(output_path);
+        if (!f)
+        {
+            error = "can't open file for writing: " + output_path.string();
+            return false;
+        }
+        f << j.dump(4);
+        return true;
+    }
+
+}
@@ -0,0 +1,195 @@
+#include "sla/apply.hpp"
+#include "sla/csv.hpp"
+#include "sla/writer.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <exception>
+#include <fstream>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SLA_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+namespace sla
+{
+    bool load_correction(const std::filesystem::path &calib_json, Correction &out, std::string &error)
+    {
+        std::ifstream f(calib_json);
+        if (!f)
+        {
+            error = "can't open coefficients file: " + calib_json.string();
+            return false;
+        }
+
+        try
+        {
+            const auto j = nlohmann::json::parse(f);
+            const auto &coeffs = j.at("coeffs");
+            const auto &C = coeffs.at("C");
+            const auto &b = coeffs.at("b");
+
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 3; ++c)
+                    out.C.a[r][c] = C.at(r).at(c).get<double>();
+
+            out.b = {b.at("x").get<double>(), b.at("y").get<double>(), b.at("z").get<double>()};
+        }
+        catch (const std::exception &e)
+        {
+            error = "bad coefficients file " + calib_json.string() + ": " + e.what();
+            return false;
+        }
+        return true;
+    }
+
+    // The order of operations is the contract between the two kernels:
+    //   d = raw - b;  out_r = (C[r][0]*dx + C[r][1]*dy) + C[r][2]*dz
+    void apply_correction_scalar(const Correction &k,
+                                 const double *ax, const double *ay, const double *az,
+                                 double *out_x, double *out_y, double *out_z, std::size_t n)
+    {
+        const auto &C = k.C.a;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const double dx = ax[i] - k.b.x;
+            const double dy = ay[i] - k.b.y;
+            const double dz = az[i] - k.b.z;
+
+            out_x[i] = (C[0][0] * dx + C[0][1] * dy) + C[0][2] * dz;
+            out_y[i] = (C[1][0] * dx + C[1][1] * dy) + C[1][2] * dz;
+            out_z[i] = (C[2][0] * dx + C[2][1] * dy) + C[2][2] * dz;
+        }
+    }
+
+#ifdef SLA_AVX2_KERNEL
+    // target("avx2") only: FMA stays off so mul + add round like the scalar code
+    __attribute__((target("avx2")))
+    static void apply_correction_avx2(const Correction &k,
+                                      const double *ax, const double *ay, const double *az,
+                                      double *out_x, double *out_y, double *out_z, std::size_t n)
+    {
+        const auto &C = k.C.a;
+        __m256d c[3][3];
+        for (int r = 0; r < 3; ++r)
+            for (int col = 0; col < 3; ++col)
+                c[r][col] = _mm256_set1_pd(C[r][col]);
+
+        const __m256d bx = _mm256_set1_pd(k.b.x);
+        const __m256d by = _mm256_set1_pd(k.b.y);
+        const __m256d bz = _mm256_set1_pd(k.b.z);
+
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(ax + i), bx);
+            const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ay + i), by);
+            const __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(az + i), bz);
+
+            double *out[3] = {out_x, out_y, out_z};
+            for (int r = 0; r < 3; ++r)
+            {
+                const __m256d xy = _mm256_add_pd(_mm256_mul_pd(c[r][0], dx), _mm256_mul_pd(c[r][1], dy));
+                _mm256_storeu_pd(out[r] + i, _mm256_add_pd(xy, _mm256_mul_pd(c[r][2], dz)));
+            }
+        }
+
+        apply_correction_scalar(k, ax + i, ay + i, az + i, out_x + i, out_y + i, out_z + i, n - i);
+    }
+#endif
+
+    bool correction_kernel_is_avx2()
+    {
+#ifdef SLA_AVX2_KERNEL
+        static const bool has_avx2 = __builtin_cpu_supports("avx2");
+        return has_avx2;
+#else
+        return false;
+#endif
+    }
+
+    void apply_correction(const Correction &k,
+                          const double *ax, const double *ay, const double *az,
+                          double *out_x, double *out_y, double *out_z, std::size_t n)
+    {
+#ifdef SLA_AVX2_KERNEL
+        if (correction_kernel_is_avx2())
+        {
+            apply_correction_avx2(k, ax, ay, az, out_x, out_y, out_z, n);
+            return;
+        }
+#endif
+        apply_correction_scalar(k, ax, ay, az, out_x, out_y, out_z, n);
+    }
+
+    ApplyResult run_apply(const ApplyOptions &opt)
+    {
+        ApplyResult res;
+
+        Correction k;
+        if (!load_correction(opt.coeffs_path, k, res.error))
+        {
+            res.ok = false;
+            return res;
+        }
+
+        CsvWriter writer;
+        if (!writer.open(opt.output_path))
+        {
+            res.ok = false;
+            res.error = "can't open file for writing: " + opt.output_path.string();
+            return res;
+        }
+        writer.write_header(EXPECTED_HEADER);
+
+        // SoA batch: columns in, corrected columns out
+        constexpr std::size_t BATCH = 4096;
+        std::vector<double> t(BATCH), ax(BATCH), ay(BATCH), az(BATCH), cx(BATCH), cy(BATCH), cz(BATCH);
+        std::size_t used = 0;
+
+        auto flush = [&]()
+        {
+            apply_correction(k, ax.data(), ay.data(), az.data(), cx.data(), cy.data(), cz.data(), used);
+            for (std::size_t i = 0; i < used; ++i)
+                writer.write_row({t[i], cx[i], cy[i], cz[i]});
+            res.rows_out += used;
+            used = 0;
+        };
+
+        auto in = read_imu_csv_streaming(opt.input_path,
+        [&](const std::array<double, 4> &row)
+        {
+            if (opt.max_rows && res.rows_out + used >= opt.max_rows)
+                return;
+
+            t[used] = row[0];
+            ax[used] = row[1];
+            ay[used] = row[2];
+            az[used] = row[3];
+            if (++used == BATCH)
+                flush();
+        });
+        flush();
+        writer.close();
+
+        res.input_name = in.input_name;
+        res.counts = in.counts;
+
+        if (!in.ok)
+        {
+            res.ok = false;
+            res.error = in.error;
+            return res;
+        }
+        if (!writer.ok())
+        {
+            res.ok = false;
+            res.error = "write failed: " + opt.output_path.string();
+        }
+        return res;
+    }
+
+}
@@ -0,0 +1,219 @@
+#include "sla/calib_batch.hpp"
+#include "sla/writer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+
+namespace sla
+{
+    static bool ends_with(const std::string &s, const std::string &suffix)
+    {
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // Names the make_*_path helpers give the outputs of sla commands
+    static bool is_sla_output(const std::string &name)
+    {
+        for (const char *suffix : {"_calib.csv", "_calib_sweep.csv", "_clean.csv", "_resampled.csv"})
+        {
+            if (ends_with(name, suffix))
+                return true;
+        }
+        return false;
+    }
+
+    std::vector<std::filesystem::path> list_batch_inputs(const std::filesystem::path &dir,
+                                                         const std::filesystem::path &exclude,
+                                                         std::vector<BatchSkip> *skipped)
+    {
+        std::vector<std::filesystem::path> candidates;
+        std::vector<BatchSkip> skips;
+        std::error_code ec;
+
+        for (const auto &entry : std::filesystem::directory_iterator(dir, ec))
+        {
+            if (!entry.is_regular_file(ec))
+                continue;
+
+            const std::string name = entry.path().filename().string();
+            if (!ends_with(name, ".csv") && !ends_with(name, ".csv.gz") && !ends_with(name, ".csv.zst"))
+                continue;
+
+            if (std::filesystem::equivalent(entry.path(), exclude, ec))
+                continue;
+
+            if (is_sla_output(name))
+            {
+                skips.push_back({entry.path(), "sla output, not a device"});
+                continue;
+            }
+
+            candidates.push_back(entry.path());
+        }
+
+        // d.csv, d.csv.gz and d.csv.zst all write d_calib.csv/.json: the
+        // first by name (the plain file) is the device, the others are skipped
+        std::sort(candidates.begin(), candidates.end());
+        std::vector<std::filesystem::path> out;
+        std::vector<std::filesystem::path> outputs;
+        for (const auto &p : candidates)
+        {
+            const auto calib = make_calib_path(p);
+            const auto same = std::find(outputs.begin(), outputs.end(), calib);
+            if (same != outputs.end())
+            {
+                skips.push_back({p, "same outputs as " + out[static_cast<std::size_t>(same - outputs.begin())]
+                                                             .filename().string()});
+                continue;
+            }
+            outputs.push_back(calib);
+            out.push_back(p);
+        }
+
+        if (skipped)
+        {
+            std::sort(skips.begin(), skips.end(), [](const BatchSkip &a, const BatchSkip &b) { return a.input < b.input; });
+            *skipped = std::move(skips);
+        }
+        return out;
+    }
+
+    std::filesystem::path make_batch_summary_path(const std::filesystem::path &dir)
+    {
+        return dir / "calib_summary.csv";
+    }
+
+    BatchResult run_calibration_batch(const BatchOptions &opt)
+    {
+        BatchResult res;
+
+        std::error_code ec;
+        if (!std::filesystem::is_directory(opt.dir, ec))
+        {
+            res.ok = false;
+            res.error = "not a directory: " + opt.dir.string();
+            return res;
+        }
+
+        CalibrationPositions positions;
+        if (!load_calibration_positions(opt.position_path, opt.calib.gravity, positions, res.error))
+        {
+            res.ok = false;
+            return res;
+        }
+
+        const auto inputs = list_batch_inputs(opt.dir, opt.summary_path, &res.skipped);
+        if (inputs.empty())
+        {
+            res.ok = false;
+            res.error = "no device CSV files in " + opt.dir.string();
+            return res;
+        }
+
+        res.devices.resize(inputs.size());
+
+        // one device per worker at a time; inside a device everything is sequential
+        std::atomic<std::size_t> next{0};
+        auto worker = [&]()
+        {
+            for (std::size_t i = next++; i < inputs.size(); i = next++)
+            {
+                CalibrationOptions c = opt.calib;
+                c.input_path = inputs[i];
+                c.position_path = opt.position_path;
+                c.output_path = make_calib_path(inputs[i]);
+                c.verbose = false;
+                c.bootstrap.threads = 1;
+
+                auto &dev = res.devices[i];
+                dev.input = inputs[i];
+                dev.result = run_calibration(c, positions);
+                dev.pass = dev.result.ok && dev.result.fit_residual_max <= opt.max_residual;
+            }
+        };
+
+        unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, inputs.size()));
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (auto &t : pool)
+            t.join();
+
+        for (const auto &d : res.devices)
+            res.passed += d.pass ? 1 : 0;
+
+        return res;
+    }
+
+    // RFC 4180: quote when needed, double the quotes
+    static void write_csv_field(BufferedWriter &out, const std::string &s)
+    {
+        if (s.find_first_of(",\"\n") == std::string::npos)
+        {
+            out.write(s);
+            return;
+        }
+
+        out.write_char('"');
+        for (char c : s)
+        {
+            if (c == '"')
+                out.write_char('"');
+            out.write_char(c);
+        }
+        out.write_char('"');
+    }
+
+    bool write_batch_summary(const BatchResult &r, const std::filesystem::path &path, std::string &error)
+    {
+        BufferedWriter out;
+        if (!out.open(path))
+        {
+            error = "can't open file for writing: " + path.string();
+            return false;
+        }
+
+        out.write("device,ok,pass,parsed_lines,"
+                  "m11,m12,m13,m21,m22,m23,m31,m32,m33,bx,by,bz,"
+                  "fit_residual_max,corr_mag_err_max,design_cond,error\n");
+
+        for (const auto &d : r.devices)
+        {
+            const auto &c = d.result;
+
+            write_csv_field(out, d.input.filename().string());
+            out.write(c.ok ? ",1" : ",0");
+            out.write(d.pass ? ",1," : ",0,");
+            out.write(std::to_string(c.parsed_lines));
+
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    out.write_char(',');
+                    out.write_double(c.M.a[i][j]);
+                }
+            }
+            for (double v : {c.b.x, c.b.y, c.b.z, c.fit_residual_max, c.max_abs_mag_corr_steady, c.design_cond})
+            {
+                out.write_char(',');
+                out.write_double(v);
+            }
+
+            out.write_char(',');
+            write_csv_field(out, c.error);
+            out.write_char('\n');
+        }
+        out.close();
+
+        if (!out.ok())
+            error = "write failed: " + path.string();
+        return out.ok();
+    }
+
+}
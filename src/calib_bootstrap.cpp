@@ -0,0 +1,146 @@
+#include "sla/calibration.hpp"
+#include "sla/synth.hpp"   // SplitMix64
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace sla
+{
+    static constexpr std::size_t COEFFS = 24;
+
+    static void pack_coeffs(const Mat3 &M, const Vec3 &b, const Mat3 &C, std::array<double, COEFFS> &out)
+    {
+        const Vec3 d{-(C.a[0][0] * b.x + C.a[0][1] * b.y + C.a[0][2] * b.z),
+                     -(C.a[1][0] * b.x + C.a[1][1] * b.y + C.a[1][2] * b.z),
+                     -(C.a[2][0] * b.x + C.a[2][1] * b.y + C.a[2][2] * b.z)};
+
+        for (int r = 0; r < 3; ++r)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                out[3 * r + c] = M.a[r][c];
+                out[12 + 3 * r + c] = C.a[r][c];
+            }
+        }
+        out[9] = b.x;
+        out[10] = b.y;
+        out[11] = b.z;
+        out[21] = d.x;
+        out[22] = d.y;
+        out[23] = d.z;
+    }
+
+    // sorted: linear interpolation between closest ranks
+    static double percentile(const std::vector<double> &sorted, double p)
+    {
+        const double pos = p * static_cast<double>(sorted.size() - 1);
+        const auto lo = static_cast<std::size_t>(pos);
+        const std::size_t hi = std::min(lo + 1, sorted.size() - 1);
+        return sorted[lo] + (pos - static_cast<double>(lo)) * (sorted[hi] - sorted[lo]);
+    }
+
+    BootstrapResult bootstrap_calibration(
+        const std::vector<Vec3> &a_true,
+        const std::vector<PositionSubBlocks> &blocks,
+        const BootstrapOptions &opt)
+    {
+        BootstrapResult res;
+        if (opt.replicates == 0 || blocks.empty())
+            return res;
+
+        res.replicates = opt.replicates;
+        res.sub_blocks = blocks[0].n.size();
+
+        constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+        std::vector<std::array<double, COEFFS>> draws(opt.replicates);
+
+        // every replicate seeds its own generator: results don't depend on
+        // which thread ran it
+        std::atomic<std::size_t> next{0};
+        auto worker = [&]()
+        {
+            std::vector<Vec3> means(blocks.size());
+            for (std::size_t r = next++; r < opt.replicates; r = next++)
+            {
+                SplitMix64 rng(opt.seed ^ ((r + 1) * 0xD1B54A32D192ED03ull));
+
+                for (std::size_t p = 0; p < blocks.size(); ++p)
+                {
+                    const auto &blk = blocks[p];
+                    const std::size_t k = blk.n.size();
+                    Vec3 s{};
+                    std::uint64_t n = 0;
+                    for (std::size_t j = 0; j < k; ++j)
+                    {
+                        const std::size_t pick = static_cast<std::size_t>(rng.uniform() * static_cast<double>(k));
+                        s.x += blk.sum[pick].x;
+                        s.y += blk.sum[pick].y;
+                        s.z += blk.sum[pick].z;
+                        n += blk.n[pick];
+                    }
+                    const double inv = n ? 1.0 / static_cast<double>(n) : NaN;
+                    means[p] = {s.x * inv, s.y * inv, s.z * inv};
+                }
+
+                Mat3 M, C;
+                Vec3 b;
+                std::string error;
+                if (fit_calibration(a_true, means, M, b, error) && invert_mat3(M, C, error))
+                    pack_coeffs(M, b, C, draws[r]);
+                else
+                    draws[r].fill(NaN);
+            }
+        };
+
+        unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, opt.replicates));
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (auto &t : pool)
+            t.join();
+
+        std::vector<double> col;
+        col.reserve(opt.replicates);
+        for (std::size_t c = 0; c < COEFFS; ++c)
+        {
+            col.clear();
+            for (const auto &d : draws)
+            {
+                if (std::isfinite(d[c]))
+                    col.push_back(d[c]);
+            }
+
+            if (c == 0)
+                res.failed = opt.replicates - col.size();
+
+            if (col.size() < 2)
+            {
+                res.spread.se[c] = res.spread.p2_5[c] = res.spread.p97_5[c] = NaN;
+                continue;
+            }
+
+            double mean = 0.0;
+            for (double v : col)
+                mean += v;
+            mean /= static_cast<double>(col.size());
+
+            double ss = 0.0;
+            for (double v : col)
+                ss += (v - mean) * (v - mean);
+            res.spread.se[c] = std::sqrt(ss / static_cast<double>(col.size() - 1));
+
+            std::sort(col.begin(), col.end());
+            res.spread.p2_5[c] = percentile(col, 0.025);
+            res.spread.p97_5[c] = percentile(col, 0.975);
+        }
+
+        return res;
+    }
+
+}
@@ -0,0 +1,338 @@
+#include "sla/calib_cache.hpp"
+
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace sla
+{
+    // bump when the key or the entry layout changes
+    static constexpr int CACHE_VERSION = 1;
+
+    void Fnv1a64::add(const void *data, std::size_t n)
+    {
+        const auto *p = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            h_ ^= p[i];
+            h_ *= 0x100000001b3ull;
+        }
+    }
+
+    bool file_stamp(const std::filesystem::path &path, std::uint64_t &size, std::int64_t &mtime)
+    {
+        std::error_code ec;
+        size = std::filesystem::file_size(path, ec);
+        if (ec)
+            return false;
+
+        const auto t = std::filesystem::last_write_time(path, ec);
+        if (ec)
+            return false;
+        mtime = static_cast<std::int64_t>(t.time_since_epoch().count());
+        return true;
+    }
+
+    bool fingerprint_file(const std::filesystem::path &path, Fnv1a64 &h)
+    {
+        std::uint64_t size{};
+        std::int64_t mtime{};
+        if (!std::filesystem::is_regular_file(path) || !file_stamp(path, size, mtime))
+            return false;
+
+        h.add_value(size);
+        h.add_value(mtime);
+
+        std::ifstream f(path, std::ios::binary);
+        if (!f)
+            return false;
+
+        std::vector<char> block(CACHE_SAMPLE_BLOCK);
+        auto hash_at = [&](std::uint64_t offset, std::size_t n)
+        {
+            f.seekg(static_cast<std::streamoff>(offset));
+            f.read(block.data(), static_cast<std::streamsize>(n));
+            h.add(block.data(), static_cast<std::size_t>(f.gcount()));
+            return f.gcount() == static_cast<std::streamsize>(n);
+        };
+
+        if (size <= CACHE_SAMPLE_BLOCK * CACHE_SAMPLE_BLOCKS)
+        {
+            for (std::uint64_t off = 0; off < size; off += CACHE_SAMPLE_BLOCK)
+            {
+                if (!hash_at(off, static_cast<std::size_t>(std::min<std::uint64_t>(CACHE_SAMPLE_BLOCK, size - off))))
+                    return false;
+            }
+            return true;
+        }
+
+        const std::uint64_t last = size - CACHE_SAMPLE_BLOCK;
+        for (std::size_t i = 0; i < CACHE_SAMPLE_BLOCKS; ++i)
+        {
+            if (!hash_at(last * i / (CACHE_SAMPLE_BLOCKS - 1), CACHE_SAMPLE_BLOCK))
+                return false;
+        }
+        return true;
+    }
+
+    bool calib_cache_key(const CalibrationOptions &opt, const CalibrationPositions &positions, std::uint64_t &key)
+    {
+        Fnv1a64 h;
+        h.add_value(CACHE_VERSION);
+
+        if (!fingerprint_file(opt.input_path, h))
+            return false;
+
+        h.add_value(static_cast<int>(positions.range));
+        h.add_value(positions.positions.size());
+        for (const auto &p : positions.positions)
+        {
+            h.add_value(p.inner);
+            h.add_value(p.outer);
+            h.add_value(p.begin);
+            h.add_value(p.end);
+        }
+
+        h.add_value(opt.gravity);
+        h.add_value(opt.steady_start_frac);
+        h.add_value(opt.steady_end_frac);
+
+        h.add_value(opt.auto_steady.window);
+        if (opt.auto_steady.window > 0)
+        {
+            h.add_value(opt.auto_steady.threshold);
+            h.add_value(opt.auto_steady.min_rows);
+            h.add_value(opt.auto_steady.max_angle_deg);
+            h.add_value(opt.auto_steady.cluster);
+        }
+
+        h.add_value(opt.bootstrap.replicates);
+        if (opt.bootstrap.replicates > 0)
+            h.add_value(opt.bootstrap.seed);
+
+        key = h.value();
+        return true;
+    }
+
+    std::filesystem::path calib_cache_entry_path(const std::filesystem::path &dir, std::uint64_t key)
+    {
+        return dir / fmt::format("{:016x}.json", key);
+    }
+
+    // JSON has no NaN or infinity (nlohmann would dump null, which doesn't
+    // read back as a double): those are stored as "nan", "inf" and "-inf"
+    static nlohmann::json number_json(double v)
+    {
+        if (std::isnan(v))
+            return "nan";
+        if (std::isinf(v))
+            return v > 0 ? "inf" : "-inf";
+        return v;
+    }
+
+    static double number_from(const nlohmann::json &j)
+    {
+        if (!j.is_string())
+            return j.get<double>();
+
+        const auto &s = j.get_ref<const std::string &>();
+        if (s == "nan")
+            return std::numeric_limits<double>::quiet_NaN();
+        if (s == "inf")
+            return std::numeric_limits<double>::infinity();
+        if (s == "-inf")
+            return -std::numeric_limits<double>::infinity();
+        throw std::runtime_error("bad number in calibration cache entry: " + s);
+    }
+
+    static nlohmann::json vec3_json(const Vec3 &v) { return {number_json(v.x), number_json(v.y), number_json(v.z)}; }
+
+    static nlohmann::json mat3_json(const Mat3 &m)
+    {
+        nlohmann::json j = nlohmann::json::array();
+        for (int i = 0; i < 9; ++i)
+            j.push_back(number_json(m.a[i / 3][i % 3]));
+        return j;
+    }
+
+    static nlohmann::json array24_json(const std::array<double, 24> &a)
+    {
+        nlohmann::json j = nlohmann::json::array();
+        for (double v : a)
+            j.push_back(number_json(v));
+        return j;
+    }
+
+    static Vec3 vec3_from(const nlohmann::json &j) { return {number_from(j.at(0)), number_from(j.at(1)), number_from(j.at(2))}; }
+
+    static Mat3 mat3_from(const nlohmann::json &j)
+    {
+        Mat3 m;
+        for (int i = 0; i < 9; ++i)
+            m.a[i / 3][i % 3] = number_from(j.at(i));
+        return m;
+    }
+
+    static std::array<double, 24> array24_from(const nlohmann::json &j)
+    {
+        if (j.size() != 24)
+            throw std::runtime_error("bad array in calibration cache entry");
+
+        std::array<double, 24> a{};
+        for (std::size_t i = 0; i < a.size(); ++i)
+            a[i] = number_from(j.at(i));
+        return a;
+    }
+
+    bool store_calib_cache_entry(const std::filesystem::path &dir, const CalibCacheEntry &entry, std::string &error)
+    {
+        const auto &r = entry.result;
+        const auto &bs = r.bootstrap;
+
+        nlohmann::json means = nlohmann::json::array();
+        for (const auto &m : r.means)
+            means.push_back(vec3_json(m));
+
+        nlohmann::json j = {
+            {"version", CACHE_VERSION},
+            {"key", fmt::format("{:016x}", entry.key)},
+            {"output_size", entry.output_size},
+            {"output_mtime", entry.output_mtime},
+            {"result", {
+                {"parsed_lines", r.parsed_lines},
+                {"used_lines", r.used_lines},
+                {"npos", r.npos},
+                {"L", r.L},
+                {"steady_start", r.steady_start},
+                {"steady_end", r.steady_end},
+                {"steady_segments", r.steady_segments},
+                {"design_cond", number_json(r.design_cond)},
+                {"fit_residual_max", number_json(r.fit_residual_max)},
+                {"M", mat3_json(r.M)},
+                {"b", vec3_json(r.b)},
+                {"C", mat3_json(r.C)},
+                {"d", vec3_json(r.d)},
+                {"max_abs_mag_raw_all", number_json(r.max_abs_mag_raw_all)},
+                {"max_abs_mag_raw_steady", number_json(r.max_abs_mag_raw_steady)},
+                {"max_abs_mag_corr_steady", number_json(r.max_abs_mag_corr_steady)},
+                {"mag_corr_stats", {r.mag_corr_stats.count, number_json(r.mag_corr_stats.min),
+                                    number_json(r.mag_corr_stats.max), number_json(r.mag_corr_stats.mean),
+                                    number_json(r.mag_corr_stats.std)}},
+                {"means", means},
+                {"bootstrap", {
+                    {"replicates", bs.replicates},
+                    {"failed", bs.failed},
+                    {"sub_blocks", bs.sub_blocks},
+                    {"se", array24_json(bs.spread.se)},
+                    {"p2_5", array24_json(bs.spread.p2_5)},
+                    {"p97_5", array24_json(bs.spread.p97_5)}}}}},
+            {"report", entry.report}};
+
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+
+        // several batch workers may store the same entry (identical inputs)
+        const auto path = calib_cache_entry_path(dir, entry.key);
+        auto tmp = path;
+        tmp += fmt::format(".{:x}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+        {
+            std::ofstream f(tmp, std::ios::binary);
+            if (!f)
+            {
+                error = "can't write calibration cache entry: " + tmp.string();
+                return false;
+            }
+            f << j.dump();
+            if (!f.flush())
+            {
+                error = "can't write calibration cache entry: " + tmp.string();
+                return false;
+            }
+        }
+
+        std::filesystem::rename(tmp, path, ec);
+        if (ec)
+        {
+            std::filesystem::remove(tmp, ec);
+            error = "can't write calibration cache entry: " + path.string();
+            return false;
+        }
+        return true;
+    }
+
+    bool load_calib_cache_entry(const std::filesystem::path &dir, std::uint64_t key, CalibCacheEntry &out)
+    {
+        std::ifstream f(calib_cache_entry_path(dir, key), std::ios::binary);
+        if (!f)
+            return false;
+
+        try
+        {
+            const auto j = nlohmann::json::parse(f);
+            if (j.at("version").get<int>() != CACHE_VERSION || j.at("key").get<std::string>() != fmt::format("{:016x}", key))
+                return false;
+
+            CalibCacheEntry e;
+            e.key = key;
+            e.output_size = j.at("output_size").get<std::uint64_t>();
+            e.output_mtime = j.at("output_mtime").get<std::int64_t>();
+            e.report = j.at("report").get<std::string>();
+
+            const auto &jr = j.at("result");
+            auto &r = e.result;
+            r.parsed_lines = jr.at("parsed_lines").get<std::uint64_t>();
+            r.used_lines = jr.at("used_lines").get<std::uint64_t>();
+            r.npos = jr.at("npos").get<int>();
+            r.L = jr.at("L").get<std::uint64_t>();
+            r.steady_start = jr.at("steady_start").get<std::uint64_t>();
+            r.steady_end = jr.at("steady_end").get<std::uint64_t>();
+            r.steady_segments = jr.at("steady_segments").get<std::uint64_t>();
+            r.design_cond = number_from(jr.at("design_cond"));
+            r.fit_residual_max = number_from(jr.at("fit_residual_max"));
+            r.M = mat3_from(jr.at("M"));
+            r.b = vec3_from(jr.at("b"));
+            r.C = mat3_from(jr.at("C"));
+            r.d = vec3_from(jr.at("d"));
+            r.max_abs_mag_raw_all = number_from(jr.at("max_abs_mag_raw_all"));
+            r.max_abs_mag_raw_steady = number_from(jr.at("max_abs_mag_raw_steady"));
+            r.max_abs_mag_corr_steady = number_from(jr.at("max_abs_mag_corr_steady"));
+
+            const auto &st = jr.at("mag_corr_stats");
+            r.mag_corr_stats = {st.at(0).get<std::uint64_t>(), number_from(st.at(1)), number_from(st.at(2)),
+                                number_from(st.at(3)), number_from(st.at(4))};
+
+            for (const auto &m : jr.at("means"))
+                r.means.push_back(vec3_from(m));
+
+            const auto &jb = jr.at("bootstrap");
+            r.bootstrap.replicates = jb.at("replicates").get<std::size_t>();
+            r.bootstrap.failed = jb.at("failed").get<std::size_t>();
+            r.bootstrap.sub_blocks = jb.at("sub_blocks").get<std::size_t>();
+            r.bootstrap.spread.se = array24_from(jb.at("se"));
+            r.bootstrap.spread.p2_5 = array24_from(jb.at("p2_5"));
+            r.bootstrap.spread.p97_5 = array24_from(jb.at("p97_5"));
+
+            if (r.means.size() != static_cast<std::size_t>(r.npos))
+                return false;
+
+            out = std::move(e);
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+        return true;
+    }
+
+}
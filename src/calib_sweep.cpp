@@ -0,0 +1,298 @@
+#include "sla/calib_sweep.hpp"
+#include "sla/csv.hpp"
+#include "sla/writer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace sla
+{
+    void AxisMoments::add(const AxisMoments &o)
+    {
+        n += o.n;
+        for (int k = 0; k < 3; ++k)
+        {
+            sum[k] += o.sum[k];
+            sum_sq[k] += o.sum_sq[k];
+        }
+    }
+
+    SubBlockSums::SubBlockSums(std::size_t max_chunks)
+        : chunks_(max_chunks)
+    {
+    }
+
+    void SubBlockSums::add(double ax, double ay, double az)
+    {
+        if (chunks_.rows() == 0)
+            ref_ = {ax, ay, az};
+
+        const double d[3] = {ax - ref_[0], ay - ref_[1], az - ref_[2]};
+        chunks_.add([&](AxisMoments &c, bool)
+                    {
+                        c.n++;
+                        for (int k = 0; k < 3; ++k)
+                        {
+                            c.sum[k] += d[k];
+                            c.sum_sq[k] += d[k] * d[k];
+                        }
+                    });
+    }
+
+    void SubBlockSums::finish()
+    {
+        chunks_.finish();
+
+        // prefix_[i] = moments of the first i chunks
+        prefix_ = chunks_.take();
+        prefix_.insert(prefix_.begin(), AxisMoments{});
+        for (std::size_t i = 1; i < prefix_.size(); ++i)
+            prefix_[i].add(prefix_[i - 1]);
+    }
+
+    AxisMoments SubBlockSums::range(std::uint64_t begin, std::uint64_t end) const
+    {
+        if (prefix_.empty())
+            return {};
+
+        const std::uint64_t cr = chunks_.chunk_rows();
+        const std::uint64_t last = prefix_.size() - 1;
+        const std::uint64_t cb = std::min(last, (begin + cr / 2) / cr);
+        const std::uint64_t ce = end >= chunks_.rows() ? last : std::min(last, (end + cr / 2) / cr);
+        if (ce <= cb)
+            return {};
+
+        const AxisMoments &hi = prefix_[ce];
+        const AxisMoments &lo = prefix_[cb];
+
+        AxisMoments m;
+        m.n = hi.n - lo.n;
+        for (int k = 0; k < 3; ++k)
+        {
+            m.sum[k] = hi.sum[k] - lo.sum[k];
+            m.sum_sq[k] = hi.sum_sq[k] - lo.sum_sq[k];
+        }
+        return m;
+    }
+
+    std::filesystem::path make_sweep_path(const std::filesystem::path &input)
+    {
+        const auto plain = strip_compression_extension(input);
+        return plain.parent_path() / (plain.stem().string() + "_calib_sweep.csv");
+    }
+
+    static SweepWindow evaluate_window(const SubBlockSums &sums, const std::vector<Vec3> &a_true,
+                                       std::uint64_t L, double start_frac, double end_frac, double g)
+    {
+        SweepWindow w;
+        w.start_frac = start_frac;
+        w.end_frac = end_frac;
+
+        const auto npos = a_true.size();
+        const auto off = sums.offset();
+        const auto s0 = static_cast<std::uint64_t>(start_frac * static_cast<double>(L));
+        const auto s1 = static_cast<std::uint64_t>(end_frac * static_cast<double>(L));
+
+        std::vector<Vec3> means(npos);
+        for (std::size_t i = 0; i < npos; ++i)
+        {
+            const AxisMoments m = sums.range(i * L + s0, i * L + s1);
+            if (m.n == 0)
+                return w;
+
+            const double n = static_cast<double>(m.n);
+            double var = 0.0;
+            double mean[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                mean[k] = m.sum[k] / n;
+                var += std::max(0.0, m.sum_sq[k] / n - mean[k] * mean[k]);
+            }
+            means[i] = {off[0] + mean[0], off[1] + mean[1], off[2] + mean[2]};
+            w.noise_std_max = std::max(w.noise_std_max, std::sqrt(var));
+            w.rows = i == 0 ? m.n : std::min(w.rows, m.n);
+        }
+
+        Mat3 M, C;
+        Vec3 b;
+        std::string error;
+        if (!fit_calibration(a_true, means, M, b, error) || !invert_mat3(M, C, error))
+            return w;
+
+        double sq = 0.0;
+        for (std::size_t i = 0; i < npos; ++i)
+        {
+            const Vec3 &t = a_true[i];
+            const Vec3 &m = means[i];
+            const double e[3] = {
+                m.x - (M.a[0][0] * t.x + M.a[0][1] * t.y + M.a[0][2] * t.z + b.x),
+                m.y - (M.a[1][0] * t.x + M.a[1][1] * t.y + M.a[1][2] * t.z + b.y),
+                m.z - (M.a[2][0] * t.x + M.a[2][1] * t.y + M.a[2][2] * t.z + b.z)};
+            const double e2 = e[0] * e[0] + e[1] * e[1] + e[2] * e[2];
+            sq += e2;
+            w.fit_max = std::max(w.fit_max, std::sqrt(e2));
+
+            const double u[3] = {m.x - b.x, m.y - b.y, m.z - b.z};
+            double mag2 = 0.0;
+            for (int r = 0; r < 3; ++r)
+            {
+                const double c = C.a[r][0] * u[0] + C.a[r][1] * u[1] + C.a[r][2] * u[2];
+                mag2 += c * c;
+            }
+            w.mag_err_max = std::max(w.mag_err_max, std::abs(std::sqrt(mag2) - g));
+        }
+        w.fit_rms = std::sqrt(sq / static_cast<double>(npos));
+        w.ok = true;
+        return w;
+    }
+
+    SweepResult run_calibration_sweep(const SweepOptions &opt)
+    {
+        SweepResult res;
+
+        PositionRange range_kind{};
+        auto positions = read_position(opt.position_path, range_kind, res.error);
+        if (!res.error.empty())
+        {
+            res.ok = false;
+            return res;
+        }
+        if (range_kind != PositionRange::Equal)
+        {
+            res.ok = false;
+            res.error = "the sweep needs POSITION.txt without range columns (equal blocks)";
+            return res;
+        }
+        if (positions.size() < 4)
+        {
+            res.ok = false;
+            res.error = "need at least 4 positions, got " + std::to_string(positions.size());
+            return res;
+        }
+
+        SubBlockSums sums;
+        auto in = read_imu_csv_streaming(opt.input_path,
+        [&](const std::array<double, 4> &row)
+        {
+            sums.add(row[1], row[2], row[3]);
+        });
+
+        if (!in.ok)
+        {
+            res.ok = false;
+            res.error = in.error;
+            return res;
+        }
+        sums.finish();
+
+        res.parsed_lines = in.counts.parsed_lines;
+        res.npos = static_cast<int>(positions.size());
+        res.L = res.parsed_lines / positions.size();
+        res.chunk_rows = sums.chunk_rows();
+
+        if (res.L < 2 * res.chunk_rows)
+        {
+            res.ok = false;
+            res.error = "too few rows per position (L=" + std::to_string(res.L) + ")";
+            return res;
+        }
+
+        std::vector<Vec3> a_true;
+        for (const auto &p : positions)
+            a_true.push_back(gravity_true(opt.gravity, p.inner, p.outer));
+
+        // grid points as multiples of step, so 0.3 is the same 0.3 every time
+        const double eps = 1e-9;
+        const int steps = static_cast<int>(std::floor(1.0 / opt.step + eps));
+        for (int a = 0; a <= steps; ++a)
+        {
+            for (int c = a + 1; c <= steps; ++c)
+            {
+                const double s = a * opt.step;
+                const double e = c * opt.step;
+                if (e - s + eps >= opt.min_width)
+                    res.windows.push_back({s, e});
+            }
+        }
+
+        if (res.windows.empty())
+        {
+            res.ok = false;
+            res.error = "empty sweep grid (step / min width)";
+            return res;
+        }
+
+        std::atomic<std::size_t> next{0};
+        auto worker = [&]()
+        {
+            for (std::size_t i = next++; i < res.windows.size(); i = next++)
+            {
+                const auto &w = res.windows[i];
+                res.windows[i] = evaluate_window(sums, a_true, res.L, w.start_frac, w.end_frac, opt.gravity);
+            }
+        };
+
+        unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, res.windows.size()));
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (auto &t : pool)
+            t.join();
+
+        bool found = false;
+        for (std::size_t i = 0; i < res.windows.size(); ++i)
+        {
+            const auto &w = res.windows[i];
+            if (w.ok && (!found || w.fit_rms < res.windows[res.best].fit_rms))
+            {
+                res.best = i;
+                found = true;
+            }
+        }
+
+        if (!found)
+        {
+            res.ok = false;
+            res.error = "no window of the sweep gave a solvable fit";
+        }
+        return res;
+    }
+
+    bool write_sweep_csv(const SweepResult &r, const std::filesystem::path &path, std::string &error)
+    {
+        BufferedWriter out;
+        if (!out.open(path))
+        {
+            error = "can't open file for writing: " + path.string();
+            return false;
+        }
+
+        out.write("start_frac,end_frac,rows,ok,fit_rms,fit_max,mag_err_max,noise_std_max\n");
+        for (const auto &w : r.windows)
+        {
+            out.write_double(w.start_frac, 6);
+            out.write_char(',');
+            out.write_double(w.end_frac, 6);
+            out.write_char(',');
+            out.write(std::to_string(w.rows));
+            out.write(w.ok ? ",1" : ",0");
+            for (double v : {w.fit_rms, w.fit_max, w.mag_err_max, w.noise_std_max})
+            {
+                out.write_char(',');
+                out.write_double(v);
+            }
+            out.write_char('\n');
+        }
+        out.close();
+
+        if (!out.ok())
+            error = "write failed: " + path.string();
+        return out.ok();
+    }
+
+}
@@ -1,13 +1,20 @@
 #include "sla/calibration.hpp"
+#include "sla/calib_cache.hpp"
+#include "sla/apply.hpp"
+#include "sla/row_chunks.hpp"
+#include "sla/json_writer.hpp"
 #include "sla/writer.hpp"
 #include "sla/csv.hpp"
 
 #include <fstream>
 #include <cmath>
-#include <nlohmann/json.hpp>
 #include <filesystem>
 #include <fmt/core.h>
+#include <algorithm>
+#include <sstream>
+#include <cctype>
 #include <array>
+#include <limits>
 
 namespace sla
 {
@@ -18,7 +25,7 @@ namespace sla
         if (w.count() == 0)
             return s;
 
-        s.count = static_cast<int>(w.count());
+        s.count = w.count();
         s.min = w.min();
         s.max = w.max();
         s.mean = w.mean();
@@ -26,9 +33,17 @@ namespace sla
         return s;
     }
 
-    static std::vector<Position> read_position(const std::filesystem::path &path, std::string &error)
+    static std::string upper(std::string s)
+    {
+        for (auto &c : s)
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        return s;
+    }
+
+    std::vector<Position> read_position(const std::filesystem::path &path, PositionRange &range, std::string &error)
     {
         error.clear();
+        range = PositionRange::Equal;
 
         std::ifstream pos_in(path);
         if (!pos_in)
@@ -37,18 +52,70 @@ namespace sla
             return {};
         }
 
-        std::string h1, h2;
-        if (!(pos_in >> h1 >> h2)) // consume header: INNER OUTER
+        // header: INNER OUTER [ROW_START ROW_END | T_START T_END]
+        std::vector<std::string> columns;
+        std::string line;
+        std::uint64_t line_no = 0;
+
+        while (columns.empty() && std::getline(pos_in, line))
+        {
+            line_no++;
+            std::istringstream hs(line);
+            std::string name;
+            while (hs >> name)
+                columns.push_back(upper(name));
+        }
+
+        if (columns.size() == 4 && columns[2] == "ROW_START" && columns[3] == "ROW_END")
+            range = PositionRange::Rows;
+        else if (columns.size() == 4 && columns[2] == "T_START" && columns[3] == "T_END")
+            range = PositionRange::Time;
+        else if (columns.size() != 2)
         {
-            error = "Error: bad header in " + path.string();
+            error = "Error: bad header in " + path.string() +
+                    " (expected INNER OUTER [ROW_START ROW_END | T_START T_END])";
             return {};
         }
 
         std::vector<Position> positions;
 
-        int inner{0}, outer{0};
-        while (pos_in >> inner >> outer)
-            positions.push_back({inner, outer});
+        while (std::getline(pos_in, line))
+        {
+            line_no++;
+
+            const auto first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#')
+                continue;   // blank line / comment
+
+            std::istringstream ls(line);
+            std::vector<double> v;
+            double x{0.0};
+            while (ls >> x)
+                v.push_back(x);
+
+            if (!ls.eof() || v.size() != columns.size())
+            {
+                error = "Error: bad line " + std::to_string(line_no) + " in " + path.string();
+                return {};
+            }
+
+            Position p;
+            p.inner = v[0];
+            p.outer = v[1];
+            if (range != PositionRange::Equal)
+            {
+                p.begin = v[2];
+                p.end = v[3];
+
+                const bool whole_rows = p.begin >= 0 && p.begin == std::floor(p.begin) && p.end == std::floor(p.end);
+                if (!(p.end > p.begin) || (range == PositionRange::Rows && !whole_rows))
+                {
+                    error = "Error: bad range on line " + std::to_string(line_no) + " in " + path.string();
+                    return {};
+                }
+            }
+            positions.push_back(p);
+        }
 
         if (positions.empty())
         {
@@ -59,16 +126,22 @@ namespace sla
         return positions;
     }
 
+    std::vector<Position> read_position(const std::filesystem::path &path, std::string &error)
+    {
+        PositionRange range{};
+        return read_position(path, range, error);
+    }
+
     static double deg2rad(double deg)
     {
         double PI{3.14159265359};
         return deg * (PI / 180.0);
     }
 
-    static Vec3 gravity_true(double g, int inner_deg, int outer_deg)
+    Vec3 gravity_true(double g, double inner_deg, double outer_deg)
     {
-        const double phi = deg2rad(static_cast<double>(inner_deg));
-        const double psi = deg2rad(static_cast<double>(outer_deg));
+        const double phi = deg2rad(inner_deg);
+        const double psi = deg2rad(outer_deg);
 
         // a_true = Rx(-phi) * Rz(-psi) * [g,0,0]
         const double ax = g * std::cos(psi);
@@ -78,190 +151,177 @@ namespace sla
         return {ax, ay, az};
     }
 
-    static void build_system_Ax_eq_Y(
-        const std::array<Vec3, 8> &a_true,
-        const std::array<double, 8> &ax_mean,
-        const std::array<double, 8> &ay_mean,
-        const std::array<double, 8> &az_mean,
-        int npos,
-        std::vector<std::array<double, 12>> &A,
-        std::vector<double> &Y)
+    // Row i of the design matrix D is [t.x t.y t.z 1] for every axis k:
+    // mean_k = M[k] . t + b_k. The 12-unknown system is three 4-unknown least
+    // squares problems sharing D, so the 4x4 normal matrix DtD is built and
+    // factored once and solved for three right-hand sides Dt*mean_k
+    static void build_normal_system(
+        const std::vector<Vec3> &a_true,
+        const std::vector<Vec3> &means,
+        double N[4][4],
+        double rhs[3][4])
     {
-        const int rows = 3 * npos;
-        A.assign(rows, std::array<double, 12>{});
-        Y.assign(rows, 0.0);
+        for (int r = 0; r < 4; ++r)
+        {
+            for (int c = 0; c < 4; ++c)
+                N[r][c] = 0.0;
+            for (int k = 0; k < 3; ++k)
+                rhs[k][r] = 0.0;
+        }
 
-        for (int i = 0; i < npos; ++i)
+        for (std::size_t i = 0; i < means.size(); ++i)
         {
-            const Vec3 t = a_true[i]; // gravity
-            const double mx = ax_mean[i];
-            const double my = ay_mean[i];
-            const double mz = az_mean[i];
-
-            const int r0 = 3 * i + 0; // mx
-            const int r1 = 3 * i + 1; // my
-            const int r2 = 3 * i + 2; // mz
-
-            // --- row for mx: [tx ty tz  0 0 0  0 0 0  1 0 0] = mx
-            A[r0][0] = t.x; // row0: g*m11 + bx = mx
-            A[r0][1] = t.y;
-            A[r0][2] = t.z;
-            A[r0][9] = 1.0;
-            Y[r0] = mx;
-
-            // --- row for my: [0 0 0  tx ty tz  0 0 0  0 1 0] = my
-            A[r1][3] = t.x;
-            A[r1][4] = t.y;
-            A[r1][5] = t.z;
-            A[r1][10] = 1.0;
-            Y[r1] = my;
-
-            // --- row for mz: [0 0 0  0 0 0  tx ty tz  0 0 1] = mz
-            A[r2][6] = t.x;
-            A[r2][7] = t.y;
-            A[r2][8] = t.z;
-            A[r2][11] = 1.0;
-            Y[r2] = mz;
+            const double d[4] = {a_true[i].x, a_true[i].y, a_true[i].z, 1.0};
+            const double m[3] = {means[i].x, means[i].y, means[i].z};
+
+            for (int r = 0; r < 4; ++r)
+            {
+                for (int c = 0; c <= r; ++c)
+                    N[r][c] += d[r] * d[c];
+                for (int k = 0; k < 3; ++k)
+                    rhs[k][r] += d[r] * m[k];
+            }
         }
+
+        for (int r = 0; r < 4; ++r)
+            for (int c = r + 1; c < 4; ++c)
+                N[r][c] = N[c][r];
     }
 
-    // (At*A)*x = At*Y
-    static void compute_normal_equations(
-        const std::vector<std::array<double, 12>> &A,
-        const std::vector<double> &Y,
-        std::array<std::array<double, 12>, 12> &AtA,
-        std::array<double, 12> &AtY)
+    // Cholesky N = L*Lt, L written to the lower triangle of L. Fails when a
+    // pivot is not positive relative to the largest diagonal entry
+    static bool cholesky4(const double N[4][4], double L[4][4], std::string &error)
     {
-        // zero init
-        for (auto &row : AtA)
-            row.fill(0.0);
-        AtY.fill(0.0);
+        double scale = 0.0;
+        for (int i = 0; i < 4; ++i)
+            scale = std::max(scale, N[i][i]);
 
-        const int rows = (int)A.size();
-        for (int r = 0; r < rows; r++)
+        for (int j = 0; j < 4; ++j)
         {
-            const auto &ar = A[r]; // row r of A
-            const auto &yr = Y[r]; // y value for row r
+            double diag = N[j][j];
+            for (int k = 0; k < j; ++k)
+                diag -= L[j][k] * L[j][k];
 
-            // Aty += A^T * y
-            for (int i = 0; i < 12; i++)
+            if (!(diag > 1e-12 * scale))
             {
-                AtY[i] += ar[i] * yr;
+                error = "Singular/ill-conditioned system: pivot too small at col=" + std::to_string(j) +
+                        " (positions don't span enough orientations)";
+                return false;
             }
+            L[j][j] = std::sqrt(diag);
 
-            // AtA += A^T * A
-            for (int i = 0; i < 12; i++)
+            for (int i = j + 1; i < 4; ++i)
             {
-                const double ai = ar[i];
-                if (ai == 0.0)
-                    continue;
-
-                for (int j = 0; j < 12; ++j)
-                    AtA[i][j] += ai * ar[j];
+                double v = N[i][j];
+                for (int k = 0; k < j; ++k)
+                    v -= L[i][k] * L[j][k];
+                L[i][j] = v / L[j][j];
             }
         }
+        return true;
     }
 
-    static bool solve_gauss_12(
-        std::array<std::array<double, 12>, 12> A,
-        std::array<double, 12> b,
-        std::array<double, 12> &x,
-        std::string &error)
+    // L*Lt*x = rhs: forward then back substitution
+    static void cholesky4_solve(const double L[4][4], const double rhs[4], double x[4])
     {
-        // Pass a and b as copies (so they can be destroyed during the method)
-        // x — result
+        double y[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            double v = rhs[i];
+            for (int k = 0; k < i; ++k)
+                v -= L[i][k] * y[k];
+            y[i] = v / L[i][i];
+        }
+        for (int i = 3; i >= 0; --i)
+        {
+            double v = y[i];
+            for (int k = i + 1; k < 4; ++k)
+                v -= L[k][i] * x[k];
+            x[i] = v / L[i][i];
+        }
+    }
 
-        const int n = 12;
+    // 2-norm condition number of a symmetric positive definite 4x4 matrix:
+    // eigenvalues by cyclic Jacobi rotations (converges in a few sweeps)
+    static double condition_sym4(const double N[4][4])
+    {
+        double a[4][4];
+        for (int r = 0; r < 4; ++r)
+            for (int c = 0; c < 4; ++c)
+                a[r][c] = N[r][c];
 
-        for (int col = 0; col < n; ++col)
+        for (int sweep = 0; sweep < 50; ++sweep)
         {
-            // 1) find pivot row
-            int piv = col;
-            double best = std::abs(A[col][col]);
-
-            for (int r = col + 1; r < n; ++r)
+            double off = 0.0;
+            for (int p = 0; p < 4; ++p)
+                for (int q = p + 1; q < 4; ++q)
+                    off += a[p][q] * a[p][q];
+            if (off < 1e-30)
+                break;
+
+            for (int p = 0; p < 4; ++p)
             {
-                double v = std::abs(A[r][col]);
-                if (v > best)
+                for (int q = p + 1; q < 4; ++q)
                 {
-                    best = v;
-                    piv = r;
+                    if (a[p][q] == 0.0)
+                        continue;
+
+                    const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                    const double t = (theta >= 0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                    const double c = 1.0 / std::sqrt(t * t + 1.0);
+                    const double s = t * c;
+
+                    for (int k = 0; k < 4; ++k)
+                    {
+                        const double akp = a[k][p], akq = a[k][q];
+                        a[k][p] = c * akp - s * akq;
+                        a[k][q] = s * akp + c * akq;
+                    }
+                    for (int k = 0; k < 4; ++k)
+                    {
+                        const double apk = a[p][k], aqk = a[q][k];
+                        a[p][k] = c * apk - s * aqk;
+                        a[q][k] = s * apk + c * aqk;
+                    }
                 }
             }
-
-            // 2) degeneracy check
-            const double eps = 1e-12;
-            if (best < eps)
-            {
-                error = "Singular/ill-conditioned system: pivot too small at col=" + std::to_string(col);
-                return false;
-            }
-
-            // 3) swap rows
-            if (piv != col)
-            {
-                std::swap(A[piv], A[col]);
-                std::swap(b[piv], b[col]);
-            }
-
-            // 4) elimination below
-            const double diag = A[col][col];
-            for (int r = col + 1; r < n; ++r)
-            {
-                const double f = A[r][col] / diag;
-                if (f == 0.0)
-                    continue;
-
-                // A[r] -= f * A[col]
-                for (int c = col; c < n; ++c)
-                    A[r][c] -= f * A[col][c];
-
-                b[r] -= f * b[col];
-            }
         }
 
-        // back substitution
-        x.fill(0.0);
-        for (int r = n - 1; r >= 0; --r)
+        double lo = a[0][0], hi = a[0][0];
+        for (int i = 1; i < 4; ++i)
         {
-            double s = b[r];
-            for (int c = r + 1; c < n; ++c)
-                s -= A[r][c] * x[c];
+            lo = std::min(lo, a[i][i]);
+            hi = std::max(hi, a[i][i]);
+        }
+        return lo > 0.0 ? hi / lo : std::numeric_limits<double>::infinity();
+    }
 
-            const double diag = A[r][r];
-            const double eps = 1e-12;
-            if (std::abs(diag) < eps)
-            {
-                error = "Singular/ill-conditioned system: zero diagonal at r=" + std::to_string(r);
-                return false;
-            }
+    static bool fit_calibration_impl(const std::vector<Vec3> &a_true, const std::vector<Vec3> &means,
+                                     Mat3 &M, Vec3 &b, double *cond, std::string &error)
+    {
+        double N[4][4], rhs[3][4], L[4][4];
+        build_normal_system(a_true, means, N, rhs);
 
-            x[r] = s / diag;
+        if (!cholesky4(N, L, error))
+            return false;
+
+        double *bias[3] = {&b.x, &b.y, &b.z};
+        for (int k = 0; k < 3; ++k)
+        {
+            double x[4];
+            cholesky4_solve(L, rhs[k], x);
+            M.a[k][0] = x[0];
+            M.a[k][1] = x[1];
+            M.a[k][2] = x[2];
+            *bias[k] = x[3];
         }
 
+        // cond(D) = sqrt(cond(DtD))
+        if (cond)
+            *cond = std::sqrt(condition_sym4(N));
         return true;
     }
 
-    static void unpack_params(
-        const std::array<double, 12> &x,
-        Mat3 &M,
-        Vec3 &b)
-    {
-        M.a[0][0] = x[0];
-        M.a[0][1] = x[1];
-        M.a[0][2] = x[2];
-        M.a[1][0] = x[3];
-        M.a[1][1] = x[4];
-        M.a[1][2] = x[5];
-        M.a[2][0] = x[6];
-        M.a[2][1] = x[7];
-        M.a[2][2] = x[8];
-
-        b.x = x[9];
-        b.y = x[10];
-        b.z = x[11];
-    }
-
     static Vec3 vec3_sub(const Vec3 &a, const Vec3 &b)
     {
         return {a.x - b.x, a.y - b.y, a.z - b.z};
@@ -276,8 +336,19 @@ namespace sla
         return r;
     }
 
-    // Invert 3x3 matrix. Returns false if det ~ 0.
-    static bool invert_mat3(const Mat3 &M, Mat3 &Minv, std::string &error)
+    bool fit_calibration(const std::vector<Vec3> &a_true, const std::vector<Vec3> &means,
+                         Mat3 &M, Vec3 &b, std::string &error)
+    {
+        return fit_calibration_impl(a_true, means, M, b, nullptr, error);
+    }
+
+    bool fit_calibration(const std::vector<Vec3> &a_true, const std::vector<Vec3> &means,
+                         Mat3 &M, Vec3 &b, double &cond, std::string &error)
+    {
+        return fit_calibration_impl(a_true, means, M, b, &cond, error);
+    }
+
+    bool invert_mat3(const Mat3 &M, Mat3 &Minv, std::string &error)
     {
         const double a00 = M.a[0][0], a01 = M.a[0][1], a02 = M.a[0][2];
         const double a10 = M.a[1][0], a11 = M.a[1][1], a12 = M.a[1][2];
@@ -322,32 +393,173 @@ namespace sla
         return true;
     }
 
+    BlockLayout make_block_layout(
+        std::uint64_t N,
+        std::uint64_t npos,
+        double steady_start_frac,
+        double steady_end_frac)
+    {
+        BlockLayout b;
+        b.npos = npos;
+        if (npos == 0)
+            return b;
+
+        b.L = N / npos;
+        b.n_used = b.L * npos;
+        b.steady_start = static_cast<std::uint64_t>(steady_start_frac * static_cast<double>(b.L));
+        b.steady_end = static_cast<std::uint64_t>(steady_end_frac * static_cast<double>(b.L));
+        return b;
+    }
+
+    BlockLayout make_block_layout(
+        std::uint64_t N,
+        const std::vector<std::array<std::uint64_t, 2>> &dwell,
+        double steady_start_frac,
+        double steady_end_frac)
+    {
+        BlockLayout b;
+        b.npos = dwell.size();
+        b.n_used = N;
+
+        for (std::uint64_t i = 0; i < dwell.size(); ++i)
+        {
+            const auto len = static_cast<double>(dwell[i][1] - dwell[i][0]);
+            SteadyRange r;
+            r.begin = dwell[i][0] + static_cast<std::uint64_t>(steady_start_frac * len);
+            r.end = dwell[i][0] + static_cast<std::uint64_t>(steady_end_frac * len);
+            r.block = i;
+            b.ranges.push_back(r);
+        }
+
+        std::sort(b.ranges.begin(), b.ranges.end(),
+                  [](const SteadyRange &x, const SteadyRange &y) { return x.begin < y.begin; });
+        return b;
+    }
+
+    BlockLayout make_block_layout(
+        std::uint64_t N,
+        std::uint64_t npos,
+        std::vector<SteadyRange> ranges)
+    {
+        BlockLayout b;
+        b.npos = npos;
+        b.n_used = N;
+        b.ranges = std::move(ranges);
+
+        std::sort(b.ranges.begin(), b.ranges.end(),
+                  [](const SteadyRange &x, const SteadyRange &y) { return x.begin < y.begin; });
+        return b;
+    }
+
+    bool BlockLayout::steady_range_block(std::uint64_t row, std::uint64_t &block) const
+    {
+        // last range starting at or before row
+        auto it = std::upper_bound(ranges.begin(), ranges.end(), row,
+                                   [](std::uint64_t r, const SteadyRange &x) { return r < x.begin; });
+        if (it == ranges.begin())
+            return false;
+
+        --it;
+        if (row >= it->end)
+            return false;
+
+        block = it->block;
+        return true;
+    }
+
+    bool load_calibration_positions(const std::filesystem::path &path, double gravity,
+                                    CalibrationPositions &out, std::string &error)
+    {
+        out.positions = read_position(path, out.range, error);
+        if (!error.empty())
+            return false;
+
+        out.a_true.clear();
+        for (const auto &p : out.positions)
+            out.a_true.push_back(gravity_true(gravity, p.inner, p.outer));
+        return true;
+    }
+
     CalibrationResult run_calibration(const CalibrationOptions &opt)
+    {
+        CalibrationPositions pos;
+        std::string error;
+        if (!load_calibration_positions(opt.position_path, opt.gravity, pos, error))
+        {
+            CalibrationResult res;
+            res.ok = false;
+            res.error = error;
+            return res;
+        }
+        return run_calibration(opt, pos);
+    }
+
+    // The three passes; report is the JSON report text as written
+    static CalibrationResult calibrate(const CalibrationOptions &opt, const CalibrationPositions &pos,
+                                       std::string &report)
     {
         CalibrationResult res;
 
-        auto positions = read_position(opt.position_path, res.error);
+        const auto &positions = pos.positions;
+        const PositionRange range_kind = pos.range;
 
-        if (!res.error.empty())
+        // 3 equations per position, 12 unknowns (M, b)
+        if (positions.size() < 4)
         {
             res.ok = false;
+            res.error = "need at least 4 positions, got " + std::to_string(positions.size());
             return res;
         }
-        if (positions.size() != 8)
+
+        // T_START/T_END: time windows in position order, for the row lookup in pass 1
+        std::vector<std::size_t> by_time(positions.size());
+        for (std::size_t i = 0; i < by_time.size(); ++i)
+            by_time[i] = i;
+        std::sort(by_time.begin(), by_time.end(),
+                  [&](std::size_t x, std::size_t y) { return positions[x].begin < positions[y].begin; });
+
+        const bool auto_steady = opt.auto_steady.window > 0;
+        if (auto_steady && range_kind != PositionRange::Equal)
         {
             res.ok = false;
-            res.error = "expected 8 positions, got " + std::to_string(positions.size());
+            res.error = "automatic steady detection needs POSITION.txt without range columns";
             return res;
         }
+        SteadySegmenter segmenter(opt.auto_steady);
+
+        constexpr std::uint64_t NO_ROW = ~std::uint64_t{0};
+        std::vector<std::array<std::uint64_t, 2>> dwell(positions.size(), {NO_ROW, 0});
 
-        // Read data 1
+        // Read data 1: raw magnitude, dwell lookup and the chunk sums that the
+        // block means are re-binned from once N (and so the layout) is known
         double max_abs_mag_raw_all{0.0};
-        auto calib_pass1 = sla::read_imu_csv_streaming(opt.input_path,
-        [&](const std::array<double, 4> &row)
+        std::uint64_t row_count1{0};
+        RowChunkSums chunks;
+        auto calib_pass1 = sla::read_imu_csv_streaming_located(opt.input_path,
+        [&](const std::array<double, 4> &row, const RowLocation &loc)
         {
+            chunks.add(row, loc.byte_offset);
+
             const double ax_raw = row[1], ay_raw = row[2], az_raw = row[3];
             const double mag_raw = std::sqrt(ax_raw * ax_raw + ay_raw * ay_raw + az_raw * az_raw);
             max_abs_mag_raw_all = std::max(max_abs_mag_raw_all, std::abs(mag_raw - opt.gravity));
+
+            if (auto_steady)
+                segmenter.push(ax_raw, ay_raw, az_raw);
+
+            if (range_kind == PositionRange::Time)
+            {
+                // last window starting at or before t
+                auto it = std::upper_bound(by_time.begin(), by_time.end(), row[0],
+                                           [&](double t, std::size_t i) { return t < positions[i].begin; });
+                if (it != by_time.begin() && row[0] < positions[*(it - 1)].end)
+                {
+                    auto &d = dwell[*(it - 1)];
+                    d[0] = std::min(d[0], row_count1);
+                    d[1] = row_count1 + 1;
+                }
+            }
+            row_count1++;
         });
 
         if (!calib_pass1.ok)
@@ -356,11 +568,12 @@ namespace sla
             res.error = calib_pass1.error;
             return res;
         }
+        chunks.finish();
 
-        const int N = static_cast<int>(calib_pass1.counts.parsed_lines); // 80000
-        const int npos = static_cast<int>(positions.size());             // 8
+        const std::uint64_t N = calib_pass1.counts.parsed_lines; // 80000
+        const int npos = static_cast<int>(positions.size());    // 8
 
-        if (N <= 0)
+        if (N == 0)
         {
             res.ok = false;
             res.error = "no parsed data lines (N<=0)";
@@ -373,72 +586,184 @@ namespace sla
             return res;
         }
 
+        if (range_kind == PositionRange::Rows)
+        {
+            for (std::size_t i = 0; i < positions.size(); ++i)
+                dwell[i] = {static_cast<std::uint64_t>(positions[i].begin), static_cast<std::uint64_t>(positions[i].end)};
+        }
+
+        if (range_kind != PositionRange::Equal)
+        {
+            std::vector<std::array<std::uint64_t, 2>> sorted = dwell;
+            std::sort(sorted.begin(), sorted.end());
+
+            for (std::size_t i = 0; i < positions.size(); ++i)
+            {
+                if (dwell[i][0] == NO_ROW || dwell[i][1] > N)
+                {
+                    res.ok = false;
+                    res.error = "position " + std::to_string(i + 1) + ": range has no rows in the input (N=" +
+                                std::to_string(N) + ")";
+                    return res;
+                }
+                if (i > 0 && sorted[i][0] < sorted[i - 1][1])
+                {
+                    res.ok = false;
+                    res.error = "position ranges overlap in POSITION.txt";
+                    return res;
+                }
+            }
+        }
+
+        // auto: still segments matched to the positions in order
+        std::vector<SteadyRange> auto_ranges;
+        if (auto_steady)
+        {
+            segmenter.finish();
+            const auto &segments = segmenter.segments();
+            res.steady_segments = segments.size();
+
+            std::vector<std::array<double, 3>> expected;
+            for (const auto &g : pos.a_true)
+                expected.push_back({g.x, g.y, g.z});
+
+            const auto match = opt.auto_steady.cluster
+                ? cluster_steady_segments(segments, expected, opt.auto_steady.max_angle_deg)
+                : match_steady_segments(segments, expected, opt.auto_steady.max_angle_deg);
+            if (match.empty())
+            {
+                res.ok = false;
+                res.error = "found " + std::to_string(segments.size()) + " steady segments, could not match them to " +
+                            std::to_string(npos) + (opt.auto_steady.cluster ? " positions by direction" : " positions in order") +
+                            " (check the steady threshold and max angle)";
+                return res;
+            }
+
+            for (std::size_t s = 0; s < segments.size(); ++s)
+            {
+                if (match[s] >= 0)
+                    auto_ranges.push_back({segments[s].begin, segments[s].end, static_cast<std::uint64_t>(match[s])});
+            }
+        }
+
+        const BlockLayout layout = auto_steady
+            ? make_block_layout(N, static_cast<std::uint64_t>(npos), std::move(auto_ranges))
+            : (range_kind == PositionRange::Equal)
+            ? make_block_layout(N, static_cast<std::uint64_t>(npos), opt.steady_start_frac, opt.steady_end_frac)
+            : make_block_layout(N, dwell, opt.steady_start_frac, opt.steady_end_frac);
+
         // how many lines are “extra” for equal blocks
-        const int rem = (npos > 0) ? (N % npos) : 0;
-        int N_used = N;
+        const std::uint64_t rem = N - layout.n_used;
+        const std::uint64_t N_used = layout.n_used;
 
         std::string block_warning;
         if (rem != 0)
         {
-            N_used = N - rem;
             block_warning = 
                 "parsed_lines (" + std::to_string(N) + ") is not divisible by npos (" + std::to_string(npos) + "). "
                 "Truncating tail for calibration fit: dropped " + std::to_string(rem) +
                 " samples; used " + std::to_string(N_used) + ".";
 
-            fmt::println(stderr, "Warning: {}", block_warning);
+            if (opt.verbose)
+                fmt::println(stderr, "Warning: {}", block_warning);
         }
 
-        const int L = N_used / npos;
+        const std::uint64_t L = layout.L;
 
-        if (L <= 0)
+        if (range_kind == PositionRange::Equal && !auto_steady && L == 0)
         {
             res.ok = false;
             res.error = "L <= 0 (N=" + std::to_string(N) + ", npos=" + std::to_string(npos) + ")";
             return res;
         }
 
-        const int steady_start = static_cast<int>(opt.steady_start_frac * L);
-        const int steady_end = static_cast<int>(opt.steady_end_frac * L);
+        const std::uint64_t steady_start = layout.steady_start;
+        const std::uint64_t steady_end = layout.steady_end;
 
-        // Read data 2: means per block (steady only)
-        std::array<double, 8> sum_ax{}, sum_ay{}, sum_az{};
-        std::array<int, 8> cnt{};
-        std::array<double, 8> ax_mean{}, ay_mean{}, az_mean{};
+        // Means per block (steady only) from the chunk sums; only the chunks
+        // cut by a steady window's edges are read again
+        std::vector<double> sum_ax(npos), sum_ay(npos), sum_az(npos);
+        std::vector<std::uint64_t> cnt(npos);
+        std::vector<double> ax_mean(npos), ay_mean(npos), az_mean(npos);
 
-        int row_count2{0};
-        auto calib_pass2 = sla::read_imu_csv_streaming(opt.input_path,
-        [&](const std::array<double, 4> &row)
+        std::vector<std::vector<std::array<std::uint64_t, 2>>> steady_rows(npos);
+        if (layout.ranges.empty())
         {
-            if (row_count2 >= N_used)
-            {
-                row_count2++;
-                return;
-            }
-
-            const int block = row_count2 / L;  // (0...7)
-            const int offset = row_count2 % L; //  (0...L-1)
+            for (int i = 0; i < npos; ++i)
+                steady_rows[i].push_back({static_cast<std::uint64_t>(i) * L + steady_start,
+                                          static_cast<std::uint64_t>(i) * L + steady_end});
+        }
+        for (const auto &r : layout.ranges)
+            steady_rows[r.block].push_back({std::min(r.begin, N_used), std::min(r.end, N_used)});
 
-            if (block < 0 || block >= npos) {row_count2++; return;}
+        std::vector<RowRange> sum_ranges;
+        for (int i = 0; i < npos; ++i)
+        {
+            for (const auto &[b, e] : steady_rows[i])
+                sum_ranges.push_back({b, e, static_cast<std::size_t>(i)});
+        }
 
-            if (steady_start <= offset && offset < steady_end)
+        // bootstrap: the steady rows of every position in BOOTSTRAP_SUB_BLOCKS
+        // consecutive parts, sub-block j holding the steady rows with
+        // j <= index * k / total < j + 1
+        const bool do_bootstrap = opt.bootstrap.replicates > 0;
+        std::vector<PositionSubBlocks> sub_blocks(do_bootstrap ? npos : 0);
+        std::vector<std::size_t> sub_block_target(npos);
+        std::size_t targets = static_cast<std::size_t>(npos);
+        if (do_bootstrap)
+        {
+            for (int i = 0; i < npos; ++i)
             {
-                sum_ax[block] += row[1];
-                sum_ay[block] += row[2];
-                sum_az[block] += row[3];
-                cnt[block]++;
-            }
+                std::uint64_t total = 0;
+                for (const auto &[b, e] : steady_rows[i])
+                    total += e > b ? e - b : 0;
 
-            row_count2++;
-        });
+                const auto k = std::clamp<std::uint64_t>(total, 1, BOOTSTRAP_SUB_BLOCKS);
+                sub_blocks[i].sum.assign(static_cast<std::size_t>(k), Vec3{});
+                sub_blocks[i].n.assign(static_cast<std::size_t>(k), 0);
+                sub_block_target[i] = targets;
+
+                for (std::uint64_t j = 0; j < k; ++j)
+                {
+                    // steady indices [lo, hi) -> rows, across the position's ranges
+                    const std::uint64_t lo = (j * total + k - 1) / k;
+                    const std::uint64_t hi = ((j + 1) * total + k - 1) / k;
+                    std::uint64_t seen = 0;
+                    for (const auto &[b, e] : steady_rows[i])
+                    {
+                        const std::uint64_t len = e > b ? e - b : 0;
+                        const std::uint64_t from = std::max(lo, seen), to = std::min(hi, seen + len);
+                        if (from < to)
+                            sum_ranges.push_back({b + from - seen, b + to - seen, targets});
+                        seen += len;
+                    }
+                    targets++;
+                }
+            }
+        }
 
-        if (!calib_pass2.ok)
+        std::vector<Vec3> range_sum;
+        std::vector<std::uint64_t> range_n;
+        if (!sum_row_ranges(opt.input_path, chunks, sum_ranges, targets, range_sum, range_n, res.error))
         {
             res.ok = false;
-            res.error = calib_pass2.error;
             return res;
         }
 
+        for (int i = 0; i < npos; ++i)
+        {
+            sum_ax[i] = range_sum[i].x;
+            sum_ay[i] = range_sum[i].y;
+            sum_az[i] = range_sum[i].z;
+            cnt[i] = range_n[i];
+
+            for (std::size_t j = 0; do_bootstrap && j < sub_blocks[i].n.size(); ++j)
+            {
+                sub_blocks[i].sum[j] = range_sum[sub_block_target[i] + j];
+                sub_blocks[i].n[j] = range_n[sub_block_target[i] + j];
+            }
+        }
+
         for (int i = 0; i < npos; i++)
         {
 
@@ -449,39 +774,28 @@ namespace sla
                 return res;
             }
 
-            ax_mean[i] = sum_ax[i] / cnt[i];
-            ay_mean[i] = sum_ay[i] / cnt[i];
-            az_mean[i] = sum_az[i] / cnt[i];
-        }
-
-        std::array<Vec3, 8> a_true{};
-        for (int i = 0; i < npos; ++i)
-        {
-            a_true[i] = gravity_true(opt.gravity, positions[i].inner, positions[i].outer);
+            ax_mean[i] = sum_ax[i] / static_cast<double>(cnt[i]);
+            ay_mean[i] = sum_ay[i] / static_cast<double>(cnt[i]);
+            az_mean[i] = sum_az[i] / static_cast<double>(cnt[i]);
         }
 
-        std::vector<std::array<double, 12>> A;
-        std::vector<double> Y;
+        const std::vector<Vec3> &a_true = pos.a_true;
 
-        build_system_Ax_eq_Y(a_true, ax_mean, ay_mean, az_mean, npos, A, Y);
-
-        std::array<std::array<double, 12>, 12> AtA;
-        std::array<double, 12> Aty;
-        compute_normal_equations(A, Y, AtA, Aty);
+        std::vector<Vec3> means(npos);
+        for (int i = 0; i < npos; ++i)
+            means[i] = {ax_mean[i], ay_mean[i], az_mean[i]};
 
-        std::array<double, 12> x;
+        Mat3 M;
+        Vec3 b;
         std::string solve_error;
-        if (!solve_gauss_12(AtA, Aty, x, solve_error))
+        double design_cond{0.0};
+        if (!fit_calibration(a_true, means, M, b, design_cond, solve_error))
         {
             res.ok = false;
             res.error = solve_error;
             return res;
         }
 
-        Mat3 M;
-        Vec3 b;
-        unpack_params(x, M, b);
-
         for (int i = 0; i < npos; ++i)
         {
             const Vec3 t = a_true[i];
@@ -491,9 +805,12 @@ namespace sla
             const Vec3 pred = {Mt.x + b.x, Mt.y + b.y, Mt.z + b.z};
 
             const Vec3 err = {meas.x - pred.x, meas.y - pred.y, meas.z - pred.z};
+            res.fit_residual_max = std::max(res.fit_residual_max,
+                                            std::sqrt(err.x * err.x + err.y * err.y + err.z * err.z));
 
-            fmt::println("fit i={} err=({:.6f},{:.6f},{:.6f})",
-                         i, err.x, err.y, err.z);
+            if (opt.verbose)
+                fmt::println("fit i={} err=({:.6f},{:.6f},{:.6f})",
+                             i, err.x, err.y, err.z);
         }
 
         Mat3 Minv;
@@ -505,7 +822,108 @@ namespace sla
             return res;
         }
 
-        nlohmann::ordered_json points = nlohmann::ordered_json::array();
+        if (do_bootstrap)
+            res.bootstrap = bootstrap_calibration(a_true, sub_blocks, opt.bootstrap);
+
+        // streamed straight into the report text; key order and formatting match dump(4)
+        report.clear();
+        JsonWriter j(report);
+
+        auto write_vec3 = [&](std::string_view name, const Vec3 &v)
+        {
+            j.key(name);
+            j.begin_object();
+            j.field("x", v.x);
+            j.field("y", v.y);
+            j.field("z", v.z);
+            j.end_object();
+        };
+        auto write_mat3 = [&](std::string_view name, const Mat3 &m)
+        {
+            j.key(name);
+            j.begin_array();
+            for (const auto &row : m.a)
+            {
+                j.begin_array();
+                for (double v : row)
+                    j.value(v);
+                j.end_array();
+            }
+            j.end_array();
+        };
+
+        const char *layout_name = auto_steady ? (opt.auto_steady.cluster ? "cluster" : "auto")
+                                : range_kind == PositionRange::Rows ? "rows"
+                                : range_kind == PositionRange::Time ? "time" : "equal";
+
+        j.begin_object();
+
+        j.key("meta");
+        j.begin_object();
+        j.field("gravity", opt.gravity);
+        j.field("layout", layout_name);
+        j.field("L", L);
+        j.field("steady_start_frac", opt.steady_start_frac);
+        j.field("steady_end_frac", opt.steady_end_frac);
+        j.field("npos", npos);
+        j.field("design_cond", design_cond);
+        j.field("parsed_lines_total", N);
+        j.field("used_lines_for_fit", N_used);
+        j.field("dropped_tail_lines", N - N_used);
+
+        if (auto_steady)
+        {
+            j.field("steady_window", opt.auto_steady.window);
+            j.field("steady_threshold", opt.auto_steady.threshold);
+            j.field("steady_segments", res.steady_segments);
+        }
+        j.end_object();
+
+        j.key("coeffs");
+        j.begin_object();
+        write_mat3("M", M);
+        write_vec3("b", b);
+        write_mat3("C", Minv);
+        j.end_object();
+
+        if (do_bootstrap)
+        {
+            const auto &bs = res.bootstrap;
+
+            // same layout as "coeffs", plus d
+            auto write_coeffs = [&](std::string_view name, const std::array<double, 24> &v)
+            {
+                auto mat = [&](int o)
+                {
+                    Mat3 m;
+                    for (int k = 0; k < 9; ++k)
+                        m.a[k / 3][k % 3] = v[o + k];
+                    return m;
+                };
+
+                j.key(name);
+                j.begin_object();
+                write_mat3("M", mat(0));
+                write_vec3("b", {v[9], v[10], v[11]});
+                write_mat3("C", mat(12));
+                write_vec3("d", {v[21], v[22], v[23]});
+                j.end_object();
+            };
+
+            j.key("bootstrap");
+            j.begin_object();
+            j.field("replicates", bs.replicates);
+            j.field("failed", bs.failed);
+            j.field("sub_blocks", bs.sub_blocks);
+            j.field("seed", opt.bootstrap.seed);
+            write_coeffs("se", bs.spread.se);
+            write_coeffs("p2_5", bs.spread.p2_5);
+            write_coeffs("p97_5", bs.spread.p97_5);
+            j.end_object();
+        }
+
+        j.key("points");
+        j.begin_array();
         for (int i = 0; i < npos; ++i)
         {
             const Vec3 ref = a_true[i];
@@ -521,54 +939,37 @@ namespace sla
             // res_corr = corr_mean - ref
             const Vec3 res_corr = vec3_sub(corr_mean, ref);
 
-            nlohmann::ordered_json point = {
-                {"position", i + 1},
-                {"ref", {{"x", ref.x}, {"y", ref.y}, {"z", ref.z}}},
-                {"raw_mean", {{"x", raw_mean.x}, {"y", raw_mean.y}, {"z", raw_mean.z}}},
-                {"corr_mean", {{"x", corr_mean.x}, {"y", corr_mean.y}, {"z", corr_mean.z}}},
-                {"res_raw", {{"x", res_raw.x}, {"y", res_raw.y}, {"z", res_raw.z}}},
-                {"res_corr", {{"x", res_corr.x}, {"y", res_corr.y}, {"z", res_corr.z}}}};
-
-            points.push_back(point);
-        }
-
-        nlohmann::ordered_json j;
-        j["meta"] = {
-            {"gravity", opt.gravity},
-            {"L", L},
-            {"steady_start_frac", opt.steady_start_frac},
-            {"steady_end_frac", opt.steady_end_frac},
-            {"npos", npos},
-            {"parsed_lines_total", N},
-            {"used_lines_for_fit", N_used},
-            {"dropped_tail_lines", (N-N_used)}
-        };
+            // first to last steady row of the position (auto may give it several segments)
+            std::uint64_t steady_begin = static_cast<std::uint64_t>(i) * L + steady_start;
+            std::uint64_t steady_end_row = static_cast<std::uint64_t>(i) * L + steady_end;
+            bool first_range = true;
+            for (const auto &r : layout.ranges)
+            {
+                if (r.block == static_cast<std::uint64_t>(i))
+                {
+                    if (first_range)
+                        steady_begin = r.begin;
+                    steady_end_row = r.end;
+                    first_range = false;
+                }
+            }
 
-        j["coeffs"] = {
-            {"M", {
-                {M.a[0][0], M.a[0][1], M.a[0][2]}, 
-                {M.a[1][0], M.a[1][1], M.a[1][2]}, 
-                {M.a[2][0], M.a[2][1], M.a[2][2]}
-            }},
-            {"b", {
-                {"x", b.x}, 
-                {"y", b.y}, 
-                {"z", b.z}
-            }},
-            {"C", {
-                {Minv.a[0][0], Minv.a[0][1], Minv.a[0][2]}, 
-                {Minv.a[1][0], Minv.a[1][1], Minv.a[1][2]}, 
-                {Minv.a[2][0], Minv.a[2][1], Minv.a[2][2]}
-            }}
-        };
-        
-        j["points"] = points;
+            j.begin_object();
+            j.field("position", i + 1);
+            j.field("steady_rows", std::vector<std::uint64_t>{steady_begin, steady_end_row});
+            write_vec3("ref", ref);
+            write_vec3("raw_mean", raw_mean);
+            write_vec3("corr_mean", corr_mean);
+            write_vec3("res_raw", res_raw);
+            write_vec3("res_corr", res_corr);
+            j.end_object();
+        }
+        j.end_array();
 
         if (!block_warning.empty())
-        {
-            j["warnings"] = nlohmann::ordered_json::array();
-            j["warnings"].push_back(block_warning);
-        }
+            j.field("warnings", std::vector<std::string>{block_warning});
+
+        j.end_object();
 
         std::filesystem::path report_path = std::filesystem::path(opt.output_path);
         report_path.replace_extension(".json");
@@ -580,7 +981,7 @@ namespace sla
             res.error = "can't open calibration report file for writing: " + report_path.string();
             return res;
         }
-        file << j.dump(4);
+        file << report;
         file.close();
 
         sla::CsvWriter calib_writer;
@@ -596,7 +997,11 @@ namespace sla
         double max_abs_mag_raw_minus_g_steady{0.0};
         double max_abs_mag_corr_minus_g_steady{0.0};
 
-        int row_count3{0};
+        std::uint64_t row_count3{0};
+
+        // the apply kernel, so the CSV rounds exactly like `sla apply` (and a
+        // cache hit's rewrite) with the same coefficients
+        const Correction corr_k{Minv, b};
 
         auto calib_pass3 = sla::read_imu_csv_streaming(opt.input_path,
         [&](const std::array<double, 4> &row)
@@ -607,15 +1012,15 @@ namespace sla
                 return;
             }
 
-            const int block = row_count3 / L;  // (0...7)
-            const int offset = row_count3 % L; //  (0...L-1)
+            std::uint64_t block{0};
+            const bool steady = layout.steady_block(row_count3, block);
 
             // raw accel
             const Vec3 raw{row[1], row[2], row[3]};
 
             // a_corr = Minv * (raw - b)
-            const Vec3 raw_minus_b = vec3_sub(raw, b);
-            const Vec3 corr = mat3_mul_vec3(Minv, raw_minus_b);
+            Vec3 corr;
+            apply_correction_scalar(corr_k, &raw.x, &raw.y, &raw.z, &corr.x, &corr.y, &corr.z, 1);
 
             const double mag_raw = std::sqrt(raw.x * raw.x + raw.y * raw.y + raw.z * raw.z);
             const double mag_corr = std::sqrt(corr.x * corr.x + corr.y * corr.y + corr.z * corr.z);
@@ -628,7 +1033,7 @@ namespace sla
             calib_writer.write_row(out);
 
             // steady-only metrics (valid blocks only)
-            if (steady_start <= offset && offset < steady_end)
+            if (steady)
             {
                 mag_corr_stats.update(mag_corr);
 
@@ -661,20 +1066,26 @@ namespace sla
         }
 
         res.max_abs_mag_raw_all = max_abs_mag_raw_all;
-        res.parsed_lines = static_cast<std::size_t>(N);
+        res.parsed_lines = N;
+        res.used_lines = N_used;
         res.npos = npos;
         res.L = L;
         res.steady_start = steady_start;
         res.steady_end = steady_end;
+        res.design_cond = design_cond;
         res.M = M;
         res.b = b;
         res.C = Minv; // correction matrix
         res.d = mat3_mul_vec3(Minv, {-b.x, -b.y, -b.z});    // correction bias
+        res.means = means;
         res.max_abs_mag_raw_steady = max_abs_mag_raw_minus_g_steady;
         res.max_abs_mag_corr_steady = max_abs_mag_corr_minus_g_steady;
 
         res.mag_corr_stats = to_stats(mag_corr_stats);
 
+        if (!opt.verbose)
+            return res;
+
         fmt::println("Raw(steady)  max(|mag-g|) = {:.6f}", max_abs_mag_raw_minus_g_steady);
         fmt::println("Corr(steady) max(|mag-g|) = {:.6f}", max_abs_mag_corr_minus_g_steady);
         fmt::println("Corr mag stats(steady): mean={:.6f}, std={:.6f}, min={:.6f}, max={:.6f}",
@@ -683,4 +1094,90 @@ namespace sla
 
         return res;
     }
-}
+
+    // A hit rewrites the JSON report from the entry; the corrected CSV only
+    // if it's not the one the entry recorded (then with run_apply: pass 3
+    // uses the same kernel)
+    static bool restore_calibration(const CalibrationOptions &opt, CalibCacheEntry &entry, std::string &error)
+    {
+        std::filesystem::path report_path = opt.output_path;
+        report_path.replace_extension(".json");
+
+        std::ofstream file(report_path.string());
+        if (!file || !(file << entry.report))
+        {
+            error = "can't open calibration report file for writing: " + report_path.string();
+            return false;
+        }
+        file.close();
+
+        std::uint64_t size{};
+        std::int64_t mtime{};
+        if (file_stamp(opt.output_path, size, mtime) && size == entry.output_size && mtime == entry.output_mtime)
+            return true;
+
+        ApplyOptions ap;
+        ap.input_path = opt.input_path;
+        ap.output_path = opt.output_path;
+        ap.max_rows = entry.result.used_lines;
+
+        // run_apply reads C and b from a calib JSON: the report just written
+        ap.coeffs_path = report_path;
+        const auto r = run_apply(ap);
+        if (!r.ok)
+        {
+            error = r.error;
+            return false;
+        }
+
+        if (file_stamp(opt.output_path, entry.output_size, entry.output_mtime))
+            store_calib_cache_entry(opt.cache_dir, entry, error);
+        error.clear();
+        return true;
+    }
+
+    CalibrationResult run_calibration(const CalibrationOptions &opt, const CalibrationPositions &pos)
+    {
+        std::string report;
+        std::uint64_t key{};
+
+        // unreadable for fingerprinting (not a regular file): no cache
+        if (opt.cache_dir.empty() || !calib_cache_key(opt, pos, key))
+            return calibrate(opt, pos, report);
+
+        CalibCacheEntry entry;
+        if (load_calib_cache_entry(opt.cache_dir, key, entry))
+        {
+            CalibrationResult res;
+            if (!restore_calibration(opt, entry, res.error))
+            {
+                res.ok = false;
+                return res;
+            }
+
+            if (opt.verbose)
+                fmt::println("Calibration cache hit: {}", calib_cache_entry_path(opt.cache_dir, key).string());
+
+            entry.result.cache_hit = true;
+            return entry.result;
+        }
+
+        auto res = calibrate(opt, pos, report);
+        if (!res.ok)
+            return res;
+
+        entry.key = key;
+        entry.result = res;
+        entry.report = std::move(report);
+
+        std::string error;
+        if (!file_stamp(opt.output_path, entry.output_size, entry.output_mtime) ||
+            !store_calib_cache_entry(opt.cache_dir, entry, error))
+        {
+            // the calibration itself succeeded; a cache that can't be written only costs the next run
+            if (opt.verbose)
+                fmt::println(stderr, "Warning: {}", error.empty() ? "can't stamp " + opt.output_path.string() : error);
+        }
+        return res;
+    }
+}
\ No newline at end of file
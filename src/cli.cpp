@@ -1,13 +1,19 @@
 #include "sla/cli.hpp"
+#include "sla/number_parse.hpp"
+#include "sla/fft.hpp"
 
+#include <charconv>
+#include <cstdint>
 #include <fmt/core.h>
+#include <system_error>
 
 namespace sla::cli
 {
 
     static bool is_command(std::string_view s)
     {
-        return s == "analyze" || s == "clean" || s == "calib";
+        return s == "analyze" || s == "clean" || s == "calib" || s == "gen" || s == "resample" || s == "allan" ||
+               s == "apply";
     }
 
     static Command parse_command(std::string_view s)
@@ -18,24 +24,115 @@ namespace sla::cli
             return Command::Clean;
         if (s == "calib")
             return Command::Calib;
+        if (s == "gen")
+            return Command::Gen;
+        if (s == "resample")
+            return Command::Resample;
+        if (s == "allan")
+            return Command::Allan;
+        if (s == "apply")
+            return Command::Apply;
 
         return Command::None;
     }
 
+    static bool parse_u64(std::string_view s, std::uint64_t &out)
+    {
+        auto res = std::from_chars(s.data(), s.data() + s.size(), out);
+        return res.ec == std::errc() && res.ptr == s.data() + s.size();
+    }
+
+    // Value after a numeric option, e.g. "--rows 1000000"
+    static bool parse_number(std::string_view s, std::uint64_t &out) { return parse_u64(s, out); }
+    static bool parse_number(std::string_view s, double &out) { return sla::parse_simple_double(s, out); }
+
     void print_usage(std::string_view prog)
     {
         const auto p = prog.empty() ? "sla" : prog;
 
         fmt::println(
             "Usage:\n"
-            "  {0} analyze --input <file>\n"
-            "  {0} clean   --input <file>\n"
-            "  {0} calib   --input <file> [--position <file>]\n"
+            "  {0} analyze --input <file> [--report <file>] [--psd N]\n"
+            "  {0} clean   --input <file> [--output <file>] [--report <file>] [--reorder-window N [--dedup]]\n"
+            "                  [--hampel K [--hampel-threshold T] [--hampel-mode M]] [--rejects <file>]\n"
+            "  {0} calib   --input <file> [--position <file>] [--auto-steady N [--steady-threshold S] [--cluster]]\n"
+            "                  [--bootstrap N [--threads N]] [--cache <dir>]\n"
+            "                  [--sweep [--sweep-step F] [--threads N] [--output <file>]]\n"
+            "  {0} calib   --batch <dir> [--position <file>] [--threads N] [--max-residual R] [--output <file>]\n"
+            "                  [--cache <dir>]\n"
+            "  {0} resample --input <file> --rate HZ [--output <file>] [--kernel K] [--gap P --max-gap MS]\n"
+            "  {0} allan   --input <file> [--output <file>] [--threads N] [--points-per-decade N]\n"
+            "  {0} apply   --input <file> --coeffs <file> [--output <file>]\n"
+            "  {0} gen     --output <file> [--rows N] [--rate HZ] [--position <file>] ...\n"
             "\n"
             "Options:\n"
-            "  --input <file>      Input CSV file\n"
+            "  --input <file>      Input CSV file (.gz/.zst ok), '-' = stdin (analyze, clean)\n"
             "  --position <file>   (calib) Path to POSITION.txt (default: рядом з input)\n"
-            "  -h, --help          Show this help\n",
+            "                      (gen) Write calibration blocks for these positions\n"
+            "  --output <file>     (clean) Clean CSV (default: <input>_clean.csv, stdin -> stdout)\n"
+            "                      (resample) Default: <input>_resampled.csv, stdin -> stdout\n"
+            "                      (allan) Default: <input>_allan.json; *.csv -> CSV table\n"
+            "                      (calib --sweep) Default: <input>_calib_sweep.csv\n"
+            "                      (apply) Default: <input>_calib.csv, stdin -> stdout\n"
+            "                      (gen) Output CSV file; '-' = stdout\n"
+            "  --coeffs <file>     (apply) Calib JSON whose C and b correct every row:\n"
+            "                      a = C * (raw - b)\n"
+            "  --report <file>     (analyze, clean) JSON report (default: <input>.json;\n"
+            "                      stdin -> stdout for analyze, none for clean); '-' = stdout\n"
+            "  --rejects <file>    (clean) Write every bad line to <file> as line,reason,raw\n"
+            "  --psd N             (analyze, clean) Welch PSD per axis in the report:\n"
+            "                      Hann window of N samples (power of two), 50% overlap\n"
+            "  --reorder-window N  (clean) Sort rows by t_ms through an N-row buffer;\n"
+            "                      rows displaced by more than N are dropped\n"
+            "  --dedup             (clean) With --reorder-window: drop exact duplicate rows\n"
+            "  --hampel K          (clean) Hampel outlier filter per axis, window 2K+1 rows\n"
+            "  --hampel-threshold T  Outlier if |x - median| > T * 1.4826 * MAD (default: 3)\n"
+            "  --hampel-mode M     flag | drop | replace (default: replace with the median)\n"
+            "  --auto-steady N     (calib) Detect the still segments with an N-row rolling\n"
+            "                      window and match them to POSITION.txt in order\n"
+            "  --steady-threshold S  Still if the window's accel std is <= S m/s^2 (default: 0.05)\n"
+            "  --steady-max-angle D  Max angle between a segment and its position's gravity\n"
+            "                      direction, degrees (default: 15)\n"
+            "  --cluster           With --auto-steady: assign the segments to positions by\n"
+            "                      direction (k-means seeded from POSITION.txt), any order\n"
+            "  --bootstrap N       (calib) Refit N times from resampled steady sub-blocks;\n"
+            "                      standard errors and 95% intervals in the calib JSON\n"
+            "  --batch <dir>       (calib) Calibrate every device CSV in <dir> on a thread pool;\n"
+            "                      POSITION.txt defaults to <dir>/POSITION.txt, summary to\n"
+            "                      <dir>/calib_summary.csv (--output)\n"
+            "  --cache <dir>       (calib) Reuse results keyed by the input fingerprint (size,\n"
+            "                      mtime, sampled blocks), POSITION.txt and settings: a hit\n"
+            "                      skips the fit and rewrites only missing/changed outputs\n"
+            "  --max-residual R    (calib --batch) Pass if the max fit residual is <= R m/s^2\n"
+            "                      (default: 0.01)\n"
+            "  --sweep             (calib) Fit every steady window on a grid of start/end\n"
+            "                      fractions from one read of the input; CSV of fit quality\n"
+            "  --sweep-step F      Grid step of the fractions (default: 0.05)\n"
+            "  -h, --help          Show this help\n"
+            "\n"
+            "Resample options (resample):\n"
+            "  --rate HZ           Output grid rate\n"
+            "  --kernel K          linear | nearest (default: linear)\n"
+            "  --max-gap MS        Input intervals longer than MS are gaps (default: off)\n"
+            "  --gap P             fill: interpolate across gaps, split: no rows inside them\n"
+            "                      (default: fill)\n"
+            "\n"
+            "Allan deviation options (allan):\n"
+            "  --threads N         Worker threads (default: all cores), also for calib\n"
+            "                      --sweep / --bootstrap\n"
+            "  --points-per-decade N  Cluster sizes per decade of tau (default: 10)\n"
+            "\n"
+            "Generator options (gen):\n"
+            "  --rows N            Number of data rows (default: 100000)\n"
+            "  --rate HZ           Sampling rate (default: 100)\n"
+            "  --seed N            RNG seed; same seed -> same file (default: 1)\n"
+            "  --jitter MS         Uniform timestamp jitter, +-MS (default: 0)\n"
+            "  --gap-ratio R       Probability of a gap before a sample (default: 0)\n"
+            "  --gap-ms MS         Gap length (default: 100)\n"
+            "  --dup-ratio R       Probability of a duplicate timestamp (default: 0)\n"
+            "  --ooo-ratio R       Probability of a timestamp stepping back (default: 0)\n"
+            "  --bad-ratio R       Probability of a malformed line before a row (default: 0)\n"
+            "  --noise A           Uniform accel noise, +-A (default: 0.01)\n",
             p);
     }
 
@@ -44,6 +141,10 @@ namespace sla::cli
         Options opt;
 
         bool cmd_set_by_subcommand = false;
+        bool hampel_opts_seen = false;
+        bool steady_opts_seen = false;
+        bool sweep_step_seen = false;
+        bool max_residual_seen = false;
         int i = 1;
 
         if (i < argc && argv[i])
@@ -60,7 +161,7 @@ namespace sla::cli
             else if (!first.empty() && first[0] != '-' && !is_command(first))
             {
                 // A positional token that is not a command => error (keeps CLI strict)
-                return Error{fmt::format("unknown command: {} (expected: analyze|clean|calib)", first)};
+                return Error{fmt::format("unknown command: {} (expected: analyze|clean|calib|resample|allan|apply|gen)", first)};
             }
         }
 
@@ -87,6 +188,220 @@ namespace sla::cli
 
                 opt.position_file = argv[++i];
             }
+            else if (arg == "--output")
+            {
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{"missing value after --output"};
+
+                opt.output_file = argv[++i];
+            }
+            else if (arg == "--coeffs")
+            {
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{"missing value after --coeffs"};
+
+                opt.coeffs_file = argv[++i];
+            }
+            else if (arg == "--report")
+            {
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{"missing value after --report"};
+
+                opt.report_file = argv[++i];
+            }
+            else if (arg == "--rejects")
+            {
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{"missing value after --rejects"};
+
+                opt.rejects_file = argv[++i];
+            }
+            else if (arg == "--reorder-window")
+            {
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{"missing value after --reorder-window"};
+
+                const std::string_view value = argv[++i];
+                if (!parse_number(value, opt.reorder_window) || opt.reorder_window == 0)
+                    return Error{fmt::format("invalid value for --reorder-window: {}", value)};
+            }
+            else if (arg == "--psd")
+            {
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{"missing value after --psd"};
+
+                const std::string_view value = argv[++i];
+                if (!parse_number(value, opt.psd_window) || opt.psd_window < 4 || opt.psd_window > (1u << 24) ||
+                    !sla::is_power_of_two(static_cast<std::size_t>(opt.psd_window)))
+                    return Error{fmt::format("invalid value for --psd (power of two, 4 .. 2^24): {}", value)};
+            }
+            else if (arg == "--hampel" || arg == "--hampel-threshold" || arg == "--hampel-mode")
+            {
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{fmt::format("missing value after {}", arg)};
+
+                const std::string_view value = argv[++i];
+                auto &h = opt.hampel;
+                std::uint64_t k = 0;
+
+                bool ok = false;
+                if (arg == "--hampel")
+                {
+                    ok = parse_number(value, k) && k > 0 && k <= 10000;
+                    h.half_window = static_cast<std::size_t>(k);
+                }
+                else if (arg == "--hampel-threshold") ok = parse_number(value, h.threshold) && h.threshold > 0.0;
+                else ok = sla::parse_hampel_mode(value, h.mode);
+
+                if (!ok)
+                    return Error{fmt::format("invalid value for {}: {}", arg, value)};
+
+                hampel_opts_seen = true;
+            }
+            else if (arg == "--auto-steady" || arg == "--steady-threshold" || arg == "--steady-max-angle")
+            {
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{fmt::format("missing value after {}", arg)};
+
+                const std::string_view value = argv[++i];
+                auto &s = opt.steady;
+                std::uint64_t n = 0;
+
+                bool ok = false;
+                if (arg == "--auto-steady")
+                {
+                    ok = parse_number(value, n) && n >= 2 && n <= 1000000;
+                    s.window = static_cast<std::size_t>(n);
+                }
+                else if (arg == "--steady-threshold") ok = parse_number(value, s.threshold) && s.threshold > 0.0;
+                else ok = parse_number(value, s.max_angle_deg) && s.max_angle_deg > 0.0 && s.max_angle_deg < 90.0;
+
+                if (!ok)
+                    return Error{fmt::format("invalid value for {}: {}", arg, value)};
+
+                steady_opts_seen = true;
+            }
+            else if (arg == "--cluster")
+            {
+                opt.steady.cluster = true;
+                steady_opts_seen = true;
+            }
+            else if (arg == "--sweep")
+            {
+                opt.sweep = true;
+            }
+            else if (arg == "--bootstrap")
+            {
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{"missing value after --bootstrap"};
+
+                const std::string_view value = argv[++i];
+                std::uint64_t n = 0;
+                if (!parse_number(value, n) || n < 10 || n > 1000000)
+                    return Error{fmt::format("invalid value for --bootstrap (10 .. 1000000): {}", value)};
+                opt.bootstrap.replicates = static_cast<std::size_t>(n);
+            }
+            else if (arg == "--batch")
+            {
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{"missing value after --batch"};
+                opt.batch_dir = argv[++i];
+            }
+            else if (arg == "--cache")
+            {
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{"missing value after --cache"};
+                opt.cache_dir = argv[++i];
+            }
+            else if (arg == "--max-residual")
+            {
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{"missing value after --max-residual"};
+
+                const std::string_view value = argv[++i];
+                if (!parse_number(value, opt.max_residual) || !(opt.max_residual > 0.0))
+                    return Error{fmt::format("invalid value for --max-residual: {}", value)};
+                max_residual_seen = true;
+            }
+            else if (arg == "--sweep-step")
+            {
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{"missing value after --sweep-step"};
+
+                const std::string_view value = argv[++i];
+                auto &step = opt.sweep_opt.step;
+                if (!parse_number(value, step) || !(step >= 0.005) || !(step <= 0.5))
+                    return Error{fmt::format("invalid value for --sweep-step (0.005 .. 0.5): {}", value)};
+                sweep_step_seen = true;
+            }
+            else if (arg == "--dedup")
+            {
+                opt.dedup = true;
+            }
+            else if (opt.cmd == Command::Resample &&
+                     (arg == "--rate" || arg == "--kernel" || arg == "--gap" || arg == "--max-gap"))
+            {
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{fmt::format("missing value after {}", arg)};
+
+                const std::string_view value = argv[++i];
+                auto &r = opt.resample;
+
+                bool ok = false;
+                if (arg == "--rate") ok = opt.rate_set = (parse_number(value, r.rate_hz) && r.rate_hz > 0.0);
+                else if (arg == "--kernel") ok = sla::parse_resample_kernel(value, r.kernel);
+                else if (arg == "--gap") ok = sla::parse_gap_policy(value, r.gap_policy);
+                else if (arg == "--max-gap") ok = parse_number(value, r.max_gap_ms) && r.max_gap_ms > 0.0;
+
+                if (!ok)
+                    return Error{fmt::format("invalid value for {}: {}", arg, value)};
+            }
+            else if (arg == "--threads" || arg == "--points-per-decade")
+            {
+                if (opt.cmd != Command::Allan && !(opt.cmd == Command::Calib && arg == "--threads"))
+                    return Error{fmt::format("{} is only valid for 'allan' command", arg)};
+
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{fmt::format("missing value after {}", arg)};
+
+                const std::string_view value = argv[++i];
+                std::uint64_t v = 0;
+                if (!parse_number(value, v) || v == 0 || v > 1024)
+                    return Error{fmt::format("invalid value for {}: {}", arg, value)};
+
+                if (arg == "--threads")
+                    opt.allan.threads = opt.sweep_opt.threads = opt.bootstrap.threads = static_cast<unsigned>(v);
+                else
+                    opt.allan.points_per_decade = static_cast<int>(v);
+            }
+            else if (arg == "--rows" || arg == "--rate" || arg == "--seed" || arg == "--jitter" ||
+                     arg == "--gap-ratio" || arg == "--gap-ms" || arg == "--dup-ratio" ||
+                     arg == "--ooo-ratio" || arg == "--bad-ratio" || arg == "--noise")
+            {
+                if (opt.cmd != Command::Gen)
+                    return Error{fmt::format("{} is only valid for 'gen' command", arg)};
+
+                if (i + 1 >= argc || !argv[i + 1])
+                    return Error{fmt::format("missing value after {}", arg)};
+
+                const std::string_view value = argv[++i];
+                auto &g = opt.gen;
+
+                bool ok = false;
+                if (arg == "--rows") ok = parse_number(value, g.rows);
+                else if (arg == "--rate") ok = parse_number(value, g.rate_hz) && g.rate_hz > 0.0;
+                else if (arg == "--seed") ok = parse_number(value, g.seed);
+                else if (arg == "--jitter") ok = parse_number(value, g.jitter_ms);
+                else if (arg == "--gap-ratio") ok = parse_number(value, g.gap_ratio);
+                else if (arg == "--gap-ms") ok = parse_number(value, g.gap_ms);
+                else if (arg == "--dup-ratio") ok = parse_number(value, g.duplicate_ratio);
+                else if (arg == "--ooo-ratio") ok = parse_number(value, g.out_of_order_ratio);
+                else if (arg == "--bad-ratio") ok = parse_number(value, g.malformed_ratio);
+                else if (arg == "--noise") ok = parse_number(value, g.noise);
+
+                if (!ok)
+                    return Error{fmt::format("invalid value for {}: {}", arg, value)};
+            }
 
             /*
             else if (arg == "--clean")
@@ -112,11 +427,116 @@ namespace sla::cli
         }
 
         // Validation
-        if (!opt.show_help && opt.input_file.empty())
+        if (opt.cmd == Command::Gen)
+        {
+            if (!opt.show_help && opt.output_file.empty())
+                return Error{"missing required option: --output <file>"};
+
+            if (!opt.input_file.empty())
+                return Error{"--input is not valid for 'gen' command"};
+
+            if (!opt.report_file.empty())
+                return Error{"--report is not valid for 'gen' command"};
+
+            return opt;
+        }
+
+        if (!opt.batch_dir.empty() && opt.cmd != Command::Calib)
+            return Error{"--batch is only valid for 'calib' command"};
+
+        if (!opt.batch_dir.empty() && !opt.input_file.empty())
+            return Error{"--batch and --input can't be combined"};
+
+        if (max_residual_seen && opt.batch_dir.empty())
+            return Error{"--max-residual needs --batch"};
+
+        if (!opt.batch_dir.empty() && opt.sweep)
+            return Error{"--batch and --sweep can't be combined"};
+
+        if (!opt.show_help && opt.input_file.empty() && opt.batch_dir.empty())
             return Error{"missing required option: --input <file>"};
 
+        if (opt.cmd == Command::Apply && !opt.show_help && opt.coeffs_file.empty())
+            return Error{"missing required option: --coeffs <file>"};
+
+        if (!opt.coeffs_file.empty() && opt.cmd != Command::Apply)
+            return Error{"--coeffs is only valid for 'apply' command"};
+
+        if (opt.cmd == Command::Resample && !opt.show_help && !opt.rate_set)
+            return Error{"missing required option: --rate HZ"};
+
+        if (opt.cmd == Command::Resample && opt.resample.gap_policy == sla::GapPolicy::Split &&
+            opt.resample.max_gap_ms <= 0.0)
+            return Error{"--gap split needs --max-gap MS"};
+
         if (!opt.position_file.empty() && opt.cmd != Command::Calib)
-            return Error{"--position is only valid for 'calib' command"};
+            return Error{"--position is only valid for 'calib' and 'gen' commands"};
+
+        if (!opt.output_file.empty() && opt.cmd != Command::Clean && opt.cmd != Command::Resample &&
+            opt.cmd != Command::Allan && opt.cmd != Command::Apply && !(opt.cmd == Command::Calib && (opt.sweep || !opt.batch_dir.empty())))
+            return Error{"--output is only valid for 'clean', 'resample', 'allan', 'apply', 'calib --sweep/--batch' and 'gen' commands"};
+
+        if ((opt.reorder_window > 0 || opt.dedup) && opt.cmd != Command::Clean)
+            return Error{"--reorder-window and --dedup are only valid for 'clean' command"};
+
+        if (opt.psd_window > 0 && opt.cmd != Command::None && opt.cmd != Command::Clean)
+            return Error{"--psd is only valid for 'analyze' and 'clean' commands"};
+
+        if (hampel_opts_seen && opt.cmd != Command::Clean)
+            return Error{"--hampel options are only valid for 'clean' command"};
+
+        if (hampel_opts_seen && opt.hampel.half_window == 0)
+            return Error{"--hampel-threshold/--hampel-mode need --hampel K"};
+
+        if (steady_opts_seen && opt.cmd != Command::Calib)
+            return Error{"--auto-steady options are only valid for 'calib' command"};
+
+        if (steady_opts_seen && opt.steady.window == 0)
+            return Error{"--steady-threshold/--steady-max-angle/--cluster need --auto-steady N"};
+
+        if (opt.sweep && opt.cmd != Command::Calib)
+            return Error{"--sweep is only valid for 'calib' command"};
+
+        if (opt.bootstrap.replicates > 0 && opt.cmd != Command::Calib)
+            return Error{"--bootstrap is only valid for 'calib' command"};
+
+        if (opt.cmd == Command::Calib && !opt.sweep && sweep_step_seen)
+            return Error{"--sweep-step needs --sweep"};
+
+        if (opt.cmd == Command::Calib && !opt.sweep && opt.bootstrap.replicates == 0 && opt.batch_dir.empty() &&
+            opt.sweep_opt.threads)
+            return Error{"--threads needs --sweep, --bootstrap or --batch"};
+
+        if (opt.sweep && opt.bootstrap.replicates > 0)
+            return Error{"--sweep and --bootstrap can't be combined"};
+
+        if (!opt.cache_dir.empty() && opt.cmd != Command::Calib)
+            return Error{"--cache is only valid for 'calib' command"};
+
+        if (!opt.cache_dir.empty() && opt.sweep)
+            return Error{"--sweep and --cache can't be combined"};
+
+        if (opt.sweep && opt.steady.window > 0)
+            return Error{"--sweep and --auto-steady can't be combined"};
+
+        if (opt.dedup && opt.reorder_window == 0)
+            return Error{"--dedup needs --reorder-window N"};
+
+        if (!opt.rejects_file.empty() && opt.cmd != Command::Clean)
+            return Error{"--rejects is only valid for 'clean' command"};
+
+        if (opt.rejects_file == "-")
+            return Error{"--rejects needs a file, not stdout"};
+
+        if (!opt.report_file.empty() && opt.cmd != Command::None && opt.cmd != Command::Clean)
+            return Error{"--report is only valid for 'analyze' and 'clean' commands"};
+
+        // calib reads its input several times
+        if (opt.cmd == Command::Calib && opt.input_file == "-")
+            return Error{"'calib' needs a seekable input file, stdin is not supported"};
+
+        if (opt.output_file == "-" && opt.report_file == "-")
+            return Error{"--output and --report can't both go to stdout"};
 
         return opt;
     }
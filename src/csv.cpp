@@ -2,8 +2,9 @@
 #include "sla/util.hpp"         // trim(std::string_view)
 #include "sla/csv_split.hpp"    // split_csv(...) + SplitStatus
 #include "sla/number_parse.hpp" // parse_row_to_array_sv(...)
+#include "sla/input_source.hpp" // open_input(...) + LineReader
 
-#include <fstream>
+#include <optional>
 #include <string>
 #include <string_view>
 
@@ -24,40 +25,41 @@ static bool is_expected_header(const std::array<std::string_view, 4> &tokens)
 }
 
 
-CsvStreamResult read_imu_csv_streaming(
-    const std::filesystem::path& path,
-    const CsvRowCallback& on_row
-    // on_row — a “handler function” that is called for each valid row
-    // “You (main) give me a function-handler, and when I get a valid string, I'll call it.”
-    // implicitly: CsvRowCallback on_row = <lambda from main>;
-)
+// Shared by the public entry points; emit(row, location) is called for each
+// valid row. start: byte offset to seek to (uncompressed files only);
+// max_rows: stop after that many parsed rows (0 = read to the end);
+// reject: called for every bad line, may be null
+template <typename Emit>
+static CsvStreamResult read_imu_csv_impl(const std::filesystem::path& path, Emit &&emit,
+                                         std::optional<std::uint64_t> start = std::nullopt,
+                                         std::uint64_t max_rows = 0,
+                                         const CsvRejectCallback *reject = nullptr)
 {
     CsvStreamResult r;
     r.input_path = path;
-    r.input_name = path.filename().string();
+    r.input_name = is_stdio_path(path) ? std::string("stdin") : path.filename().string();
 
+    // the first MAX_WARNINGS bad lines are listed one by one; every bad line
+    // goes into its category (counts + sampled examples), which doesn't
+    // allocate once the category exists
     constexpr std::size_t MAX_WARNINGS = 200;
-    auto push_warning = [&](Warning w)
-    {
-        if (r.warnings.size() < MAX_WARNINGS)
-            r.warnings.push_back(std::move(w));
-        else
-            r.warnings_dropped++;
-        
-    };
+    WarningSummary summary;
 
-    // Open the file for reading 
-    std::ifstream file(path);
-    if (!file)
+    // Open the file for reading (plain, .gz or .zst - detected by magic bytes)
+    auto input = start ? open_input_at(path, *start, r.error) : open_input(path, r.error);
+    if (!input)
     {
         r.ok = false;
-        r.error = "Error, can't open file: " + path.string();
         return r;
     }
 
-    std::string line;
+    // the 1 MiB line buffer stays with the thread: calib's passes and a
+    // batch of devices reuse it instead of allocating one per read
+    thread_local std::vector<char> spare_buffer;
+    LineReader lines(*input, std::move(spare_buffer));
+    std::string_view line;
 
-    while (std::getline(file, line))
+    while ((max_rows == 0 || r.counts.parsed_lines < max_rows) && lines.next(line))
     {
         r.counts.total_lines++;
 
@@ -87,12 +89,21 @@ CsvStreamResult read_imu_csv_streaming(
         if (split_status != sla::SplitStatus::Ok)
         {
             r.counts.bad_lines++;
-            push_warning(Warning{
-                "incorrect number of columns (expected 4, got " + std::to_string(actual_cols) + ")",
-                r.counts.total_lines,
-                std::nullopt,
-                std::nullopt
-            });
+            summary.add(WarningKind::ColumnCount, actual_cols, r.counts.total_lines, trimmed);
+            if (reject && *reject)
+                (*reject)(RejectedLine{r.counts.total_lines, WarningKind::ColumnCount, actual_cols, line});
+
+            if (r.warnings.size() < MAX_WARNINGS)
+            {
+                r.warnings.push_back(Warning{
+                    "incorrect number of columns (expected 4, got " + std::to_string(actual_cols) + ")",
+                    r.counts.total_lines,
+                    std::nullopt,
+                    std::nullopt
+                });
+            }
+            else
+                r.warnings_dropped++;
             continue;
         }
 
@@ -111,27 +122,88 @@ CsvStreamResult read_imu_csv_streaming(
         {
             r.counts.parsed_lines++;
 
-            if (on_row)
-            {
-                on_row(row); // = “execute the callback that was passed to me”
-            }
+            emit(row, RowLocation{r.counts.total_lines, lines.line_offset()});
         }
         else
         {
             r.counts.bad_lines++;
+            summary.add(WarningKind::InvalidValue, bad_idx + 1, r.counts.total_lines, tokens[bad_idx]);
+            if (reject && *reject)
+                (*reject)(RejectedLine{r.counts.total_lines, WarningKind::InvalidValue, bad_idx + 1, line});
 
-            Warning w;
-            w.line = r.counts.total_lines;
-            w.message = "invalid value";
-            w.column = bad_idx + 1;
-            w.value = std::string(tokens[bad_idx]);
+            if (r.warnings.size() < MAX_WARNINGS)
+            {
+                Warning w;
+                w.line = r.counts.total_lines;
+                w.message = "invalid value";
+                w.column = bad_idx + 1;
+                w.value = to_valid_utf8(tokens[bad_idx]);   // goes into the JSON report
 
-            push_warning(std::move(w));
+                r.warnings.push_back(std::move(w));
+            }
+            else
+                r.warnings_dropped++;
         }
     }
 
+    // End of input may also mean a truncated/corrupt archive
+    if (auto err = input->error(); !err.empty())
+    {
+        r.ok = false;
+        r.error = "Error reading " + path.string() + ": " + err;
+    }
+
+    r.warning_categories = summary.take();
+
+    spare_buffer = lines.take_buffer();
     return r;
 }
 
 
-}
\ No newline at end of file
+
+CsvStreamResult read_imu_csv_streaming(
+    const std::filesystem::path& path,
+    const CsvRowCallback& on_row
+    // on_row — a “handler function” that is called for each valid row
+    // “You (main) give me a function-handler, and when I get a valid string, I'll call it.”
+    // implicitly: CsvRowCallback on_row = <lambda from main>;
+)
+{
+    return read_imu_csv_impl(path, [&](const std::array<double, 4> &row, const RowLocation &)
+    {
+        if (on_row)
+            on_row(row); // = “execute the callback that was passed to me”
+    });
+}
+
+
+CsvStreamResult read_imu_csv_streaming_located(
+    const std::filesystem::path& path,
+    const CsvLocatedRowCallback& on_row,
+    const CsvRejectCallback& on_reject
+)
+{
+    return read_imu_csv_impl(path, [&](const std::array<double, 4> &row, const RowLocation &loc)
+    {
+        if (on_row)
+            on_row(row, loc);
+    }, std::nullopt, 0, &on_reject);
+}
+
+
+CsvStreamResult read_imu_csv_streaming_at(
+    const std::filesystem::path& path,
+    std::uint64_t byte_offset,
+    std::uint64_t max_rows,
+    const CsvRowCallback& on_row
+)
+{
+    return read_imu_csv_impl(path, [&](const std::array<double, 4> &row, const RowLocation &)
+    {
+        if (on_row)
+            on_row(row);
+    }, byte_offset, max_rows);
+}
+
+
+}
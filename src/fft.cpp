@@ -0,0 +1,115 @@
+#include "sla/fft.hpp"
+
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <utility>
+
+
+namespace sla
+{
+
+    bool is_power_of_two(std::size_t n)
+    {
+        return n != 0 && (n & (n - 1)) == 0;
+    }
+
+    RealFft::RealFft(std::size_t n)
+        : n_(n), h_(n / 2), bitrev_(n / 2), tw_re_(n / 2), tw_im_(n / 2), re_(n / 2), im_(n / 2)
+    {
+        if (n < 4 || !is_power_of_two(n))
+            throw std::invalid_argument("RealFft: size must be a power of two >= 4");
+
+        for (std::size_t k = 0; k < h_; ++k)
+        {
+            const double a = -2.0 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(n_);
+            tw_re_[k] = std::cos(a);
+            tw_im_[k] = std::sin(a);
+        }
+
+        std::size_t bits = 0;
+        while ((std::size_t{1} << bits) < h_)
+            bits++;
+
+        for (std::size_t i = 0; i < h_; ++i)
+        {
+            std::size_t r = 0;
+            for (std::size_t b = 0; b < bits; ++b)
+                r |= ((i >> b) & 1) << (bits - 1 - b);
+            bitrev_[i] = r;
+        }
+    }
+
+    void RealFft::complex_fft()
+    {
+        for (std::size_t i = 0; i < h_; ++i)
+        {
+            const std::size_t j = bitrev_[i];
+            if (i < j)
+            {
+                std::swap(re_[i], re_[j]);
+                std::swap(im_[i], im_[j]);
+            }
+        }
+
+        double *re = re_.data();
+        double *im = im_.data();
+
+        // The h-point transform needs e^{-2 pi i k / h} = tw[2k]
+        for (std::size_t len = 2; len <= h_; len <<= 1)
+        {
+            const std::size_t half = len / 2;
+            const std::size_t step = 2 * (h_ / len);
+
+            for (std::size_t start = 0; start < h_; start += len)
+            {
+                double *ar = re + start, *ai = im + start;
+                double *br = ar + half, *bi = ai + half;
+
+                for (std::size_t k = 0; k < half; ++k)
+                {
+                    const double wr = tw_re_[k * step];
+                    const double wi = tw_im_[k * step];
+                    const double tr = br[k] * wr - bi[k] * wi;
+                    const double ti = br[k] * wi + bi[k] * wr;
+                    br[k] = ar[k] - tr;
+                    bi[k] = ai[k] - ti;
+                    ar[k] += tr;
+                    ai[k] += ti;
+                }
+            }
+        }
+    }
+
+    void RealFft::forward(const double *in, double *out_re, double *out_im)
+    {
+        for (std::size_t i = 0; i < h_; ++i)
+        {
+            re_[i] = in[2 * i];
+            im_[i] = in[2 * i + 1];
+        }
+
+        complex_fft();
+
+        // Z = FFT(even + i*odd):  E[k] = (Z[k] + conj Z[h-k]) / 2,
+        // O[k] = (Z[k] - conj Z[h-k]) / 2i,  X[k] = E[k] + W^k O[k]
+        out_re[0] = re_[0] + im_[0];
+        out_im[0] = 0.0;
+        out_re[h_] = re_[0] - im_[0];
+        out_im[h_] = 0.0;
+
+        for (std::size_t k = 1; k < h_; ++k)
+        {
+            const double zr = re_[k], zi = im_[k];
+            const double cr = re_[h_ - k], ci = -im_[h_ - k];   // conj Z[h-k]
+
+            const double er = 0.5 * (zr + cr), ei = 0.5 * (zi + ci);
+            const double or_ = 0.5 * (zi - ci), oi = -0.5 * (zr - cr);
+
+            const double wr = tw_re_[k], wi = tw_im_[k];
+            out_re[k] = er + or_ * wr - oi * wi;
+            out_im[k] = ei + or_ * wi + oi * wr;
+        }
+    }
+
+}
@@ -0,0 +1,156 @@
+#include "sla/hampel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+
+namespace sla
+{
+
+    RollingMedianMad::RollingMedianMad(std::size_t size) : ring_(size)
+    {
+        sorted_.reserve(size);
+    }
+
+    void RollingMedianMad::push(double x)
+    {
+        if (full())
+        {
+            const double old = ring_[head_];
+            sorted_.erase(std::lower_bound(sorted_.begin(), sorted_.end(), old));
+        }
+        else
+        {
+            count_++;
+        }
+
+        ring_[head_] = x;
+        head_ = (head_ + 1) % ring_.size();
+        sorted_.insert(std::upper_bound(sorted_.begin(), sorted_.end(), x), x);
+    }
+
+    double RollingMedianMad::median() const
+    {
+        const std::size_t n = sorted_.size();
+        if (n == 0)
+            return 0.0;
+        return (n % 2) ? sorted_[n / 2] : 0.5 * (sorted_[n / 2 - 1] + sorted_[n / 2]);
+    }
+
+    double RollingMedianMad::mad() const
+    {
+        const std::size_t n = sorted_.size();
+        if (n == 0)
+            return 0.0;
+
+        const double med = median();
+
+        // distances grow going left from the median and going right from it:
+        // merge the two runs and stop at the middle element(s)
+        std::size_t right = static_cast<std::size_t>(std::lower_bound(sorted_.begin(), sorted_.end(), med) - sorted_.begin());
+        std::ptrdiff_t left = static_cast<std::ptrdiff_t>(right) - 1;
+
+        auto next_distance = [&]()
+        {
+            const bool take_left = left >= 0 &&
+                (right >= n || med - sorted_[static_cast<std::size_t>(left)] <= sorted_[right] - med);
+            return take_left ? med - sorted_[static_cast<std::size_t>(left--)] : sorted_[right++] - med;
+        };
+
+        double d = 0.0;
+        for (std::size_t i = 0; i <= (n - 1) / 2; ++i)
+            d = next_distance();
+
+        return (n % 2) ? d : 0.5 * (d + next_distance());
+    }
+
+    bool parse_hampel_mode(std::string_view s, HampelMode &out)
+    {
+        if (s == "flag")    { out = HampelMode::Flag;    return true; }
+        if (s == "drop")    { out = HampelMode::Drop;    return true; }
+        if (s == "replace") { out = HampelMode::Replace; return true; }
+        return false;
+    }
+
+    HampelFilter::HampelFilter(const HampelOptions &opt, Emit emit)
+        : opt_(opt), emit_(std::move(emit)),
+          windows_{RollingMedianMad(2 * opt.half_window + 1),
+                   RollingMedianMad(2 * opt.half_window + 1),
+                   RollingMedianMad(2 * opt.half_window + 1)},
+          rows_(2 * opt.half_window + 1)
+    {
+    }
+
+    void HampelFilter::push(const Row &row)
+    {
+        const std::size_t w = rows_.size();
+        const std::size_t k = opt_.half_window;
+
+        rows_[head_] = row;
+        head_ = (head_ + 1) % w;
+
+        for (int a = 0; a < 3; ++a)
+            windows_[a].push(row[a + 1]);
+
+        if (count_ < w)
+        {
+            if (++count_ < w)
+                return;
+
+            // first full window: the k rows before the first center have no window of their own
+            for (std::size_t i = 0; i < k; ++i)
+                emit_(rows_[i]);
+        }
+
+        // center = k rows back from the newest
+        Row center = rows_[(head_ + k) % w];
+        bool outlier_row = false;
+
+        for (int a = 0; a < 3; ++a)
+        {
+            const double med = windows_[a].median();
+            const double scale = 1.4826 * windows_[a].mad();
+            const double dev = std::abs(center[a + 1] - med);
+
+            if (dev > 0.0 && dev > opt_.threshold * scale)
+            {
+                stats_.outliers++;
+                outlier_row = true;
+
+                if (opt_.mode == HampelMode::Replace)
+                {
+                    center[a + 1] = med;
+                    stats_.values_replaced++;
+                }
+            }
+        }
+
+        if (outlier_row && opt_.mode == HampelMode::Drop)
+        {
+            stats_.rows_dropped++;
+            return;
+        }
+
+        emit_(center);
+    }
+
+    void HampelFilter::flush()
+    {
+        const std::size_t w = rows_.size();
+        const std::size_t k = opt_.half_window;
+
+        if (count_ < w)
+        {
+            // the window never filled: everything passes through
+            for (std::size_t i = 0; i < count_; ++i)
+                emit_(rows_[i]);
+            return;
+        }
+
+        // trailing k rows, oldest first
+        for (std::size_t i = 0; i < k; ++i)
+            emit_(rows_[(head_ + k + 1 + i) % w]);
+    }
+
+}
@@ -0,0 +1,505 @@
+#include "sla/input_source.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <zlib.h>
+#include <zstd.h>
+
+
+namespace sla
+{
+
+    bool is_stdio_path(const std::filesystem::path &path)
+    {
+        return path == "-";
+    }
+
+    Compression detect_compression(const unsigned char *magic, std::size_t n)
+    {
+        if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+            return Compression::Gzip;
+
+        if (n >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+            return Compression::Zstd;
+
+        return Compression::None;
+    }
+
+    namespace
+    {
+        // Owns the FILE* and replays the sniffed magic bytes before the rest of the file
+        class RawFile
+        {
+        public:
+            RawFile(std::FILE *f, bool owned, const unsigned char *prefix, std::size_t n)
+                : file_(f), owned_(owned), prefix_(prefix, prefix + n) {}
+
+            ~RawFile()
+            {
+                if (file_ && owned_)
+                    std::fclose(file_);
+            }
+
+            RawFile(const RawFile &) = delete;
+            RawFile &operator=(const RawFile &) = delete;
+
+            std::size_t read(void *dst, std::size_t n)
+            {
+                auto *out = static_cast<unsigned char *>(dst);
+                std::size_t got = 0;
+
+                if (prefix_pos_ < prefix_.size())
+                {
+                    got = std::min(n, prefix_.size() - prefix_pos_);
+                    std::memcpy(out, prefix_.data() + prefix_pos_, got);
+                    prefix_pos_ += got;
+                }
+
+                if (got < n)
+                    got += std::fread(out + got, 1, n - got, file_);
+
+                return got;
+            }
+
+            bool failed() const { return std::ferror(file_) != 0; }
+
+        private:
+            std::FILE *file_;
+            bool owned_;   // false for stdin
+            std::vector<unsigned char> prefix_;
+            std::size_t prefix_pos_{0};
+        };
+
+        class PlainSource final : public InputSource
+        {
+        public:
+            explicit PlainSource(std::unique_ptr<RawFile> raw) : raw_(std::move(raw)) {}
+
+            std::size_t read(char *dst, std::size_t n) override { return raw_->read(dst, n); }
+
+            std::string error() const override
+            {
+                return raw_->failed() ? std::string("read error") : std::string();
+            }
+
+            Compression compression() const override { return Compression::None; }
+
+        private:
+            std::unique_ptr<RawFile> raw_;
+        };
+
+        // Producer/consumer: the decoder thread fills CHUNK-sized buffers and blocks
+        // once MAX_QUEUED of them are waiting, so memory is bounded by ~5 chunks
+        class ThreadedDecodeSource : public InputSource
+        {
+        public:
+            static constexpr std::size_t CHUNK = std::size_t{1} << 20;
+            static constexpr std::size_t MAX_QUEUED = 4;
+
+            explicit ThreadedDecodeSource(std::unique_ptr<RawFile> raw) : raw_(std::move(raw)) {}
+
+            ~ThreadedDecodeSource() override { stop(); }
+
+            // Not in the constructor: decode() is virtual
+            void start()
+            {
+                worker_ = std::thread([this]()
+                {
+                    std::string err;
+                    decode(err);
+                    finish(std::move(err));
+                });
+            }
+
+            std::size_t read(char *dst, std::size_t n) override
+            {
+                if (cur_pos_ == cur_.size())
+                {
+                    std::unique_lock<std::mutex> lock(m_);
+                    cv_.wait(lock, [&]() { return !queue_.empty() || done_; });
+
+                    if (queue_.empty())
+                        return 0;
+
+                    cur_ = std::move(queue_.front());
+                    queue_.pop_front();
+                    cur_pos_ = 0;
+                    lock.unlock();
+                    cv_.notify_all();
+                }
+
+                const std::size_t k = std::min(n, cur_.size() - cur_pos_);
+                std::memcpy(dst, cur_.data() + cur_pos_, k);
+                cur_pos_ += k;
+                return k;
+            }
+
+            std::string error() const override
+            {
+                std::lock_guard<std::mutex> lock(m_);
+                return error_;
+            }
+
+        protected:
+            // Unblocks and joins the worker. Derived destructors call it first,
+            // so decode() never runs on a half-destroyed object
+            void stop()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_);
+                    stop_ = true;
+                }
+                cv_.notify_all();
+
+                if (worker_.joinable())
+                    worker_.join();
+            }
+
+            // Runs on the worker thread. Returns when input is exhausted,
+            // on error (err set) or when emit() returns false
+            virtual void decode(std::string &err) = 0;
+
+            std::size_t read_raw(void *dst, std::size_t n) { return raw_->read(dst, n); }
+            bool raw_failed() const { return raw_->failed(); }
+
+            // Hands decompressed bytes to the consumer; false if the consumer is gone
+            bool emit(const void *data, std::size_t n)
+            {
+                const auto *p = static_cast<const char *>(data);
+
+                while (n > 0)
+                {
+                    if (fill_.capacity() < CHUNK)
+                        fill_.reserve(CHUNK);
+
+                    const std::size_t k = std::min(n, CHUNK - fill_.size());
+                    fill_.insert(fill_.end(), p, p + k);
+                    p += k;
+                    n -= k;
+
+                    if (fill_.size() == CHUNK && !push(std::move(fill_)))
+                        return false;
+                }
+                return true;
+            }
+
+        private:
+            bool push(std::vector<char> &&chunk)
+            {
+                std::unique_lock<std::mutex> lock(m_);
+                cv_.wait(lock, [&]() { return queue_.size() < MAX_QUEUED || stop_; });
+
+                if (stop_)
+                    return false;
+
+                queue_.push_back(std::move(chunk));
+                lock.unlock();
+                cv_.notify_all();
+
+                // chunk was fill_; start a fresh one
+                fill_ = std::vector<char>();
+                return true;
+            }
+
+            void finish(std::string err)
+            {
+                // bytes decoded before an error are still delivered
+                if (!fill_.empty())
+                    push(std::move(fill_));
+
+                {
+                    std::lock_guard<std::mutex> lock(m_);
+                    error_ = std::move(err);
+                    done_ = true;
+                }
+                cv_.notify_all();
+            }
+
+            std::unique_ptr<RawFile> raw_;
+            std::thread worker_;
+
+            mutable std::mutex m_;
+            std::condition_variable cv_;
+            std::deque<std::vector<char>> queue_;
+            bool done_{false};
+            bool stop_{false};
+            std::string error_;
+
+            std::vector<char> fill_;   // producer side
+            std::vector<char> cur_;    // consumer side
+            std::size_t cur_pos_{0};
+        };
+
+        class GzipSource final : public ThreadedDecodeSource
+        {
+        public:
+            using ThreadedDecodeSource::ThreadedDecodeSource;
+            ~GzipSource() override { stop(); }
+
+            Compression compression() const override { return Compression::Gzip; }
+
+        protected:
+            void decode(std::string &err) override
+            {
+                z_stream zs{};
+                // 15 + 32: max window, accept gzip and zlib headers
+                if (inflateInit2(&zs, 15 + 32) != Z_OK)
+                {
+                    err = "gzip: inflateInit failed";
+                    return;
+                }
+
+                std::vector<unsigned char> in(std::size_t{1} << 18);
+                std::vector<unsigned char> out(std::size_t{1} << 18);
+                bool in_member = false;
+
+                for (;;)
+                {
+                    if (zs.avail_in == 0)
+                    {
+                        const std::size_t n = read_raw(in.data(), in.size());
+                        if (n == 0)
+                            break;
+                        zs.next_in = in.data();
+                        zs.avail_in = static_cast<uInt>(n);
+                    }
+
+                    in_member = true;
+                    zs.next_out = out.data();
+                    zs.avail_out = static_cast<uInt>(out.size());
+
+                    const int ret = inflate(&zs, Z_NO_FLUSH);
+                    if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+                    {
+                        err = std::string("gzip: ") + (zs.msg ? zs.msg : "corrupt data");
+                        break;
+                    }
+
+                    if (!emit(out.data(), out.size() - zs.avail_out))
+                        break;
+
+                    if (ret == Z_STREAM_END)
+                    {
+                        // concatenated members (pigz, bgzip, cat a.gz b.gz)
+                        in_member = false;
+                        inflateReset(&zs);
+                    }
+                }
+
+                if (err.empty() && raw_failed())
+                    err = "read error";
+                else if (err.empty() && in_member)
+                    err = "gzip: unexpected end of compressed data";
+
+                inflateEnd(&zs);
+            }
+        };
+
+        class ZstdSource final : public ThreadedDecodeSource
+        {
+        public:
+            using ThreadedDecodeSource::ThreadedDecodeSource;
+            ~ZstdSource() override { stop(); }
+
+            Compression compression() const override { return Compression::Zstd; }
+
+        protected:
+            void decode(std::string &err) override
+            {
+                ZSTD_DStream *ds = ZSTD_createDStream();
+                if (!ds)
+                {
+                    err = "zstd: can't create decoder";
+                    return;
+                }
+
+                std::vector<char> in(ZSTD_DStreamInSize());
+                std::vector<char> out(ZSTD_DStreamOutSize());
+
+                // 0 once a frame is complete; multiple frames are decoded back to back
+                std::size_t pending = 0;
+                bool stopped = false;
+
+                while (!stopped && err.empty())
+                {
+                    const std::size_t n = read_raw(in.data(), in.size());
+                    if (n == 0)
+                        break;
+
+                    ZSTD_inBuffer input{in.data(), n, 0};
+                    while (input.pos < input.size)
+                    {
+                        ZSTD_outBuffer output{out.data(), out.size(), 0};
+                        pending = ZSTD_decompressStream(ds, &output, &input);
+
+                        if (ZSTD_isError(pending))
+                        {
+                            err = std::string("zstd: ") + ZSTD_getErrorName(pending);
+                            break;
+                        }
+
+                        if (!emit(out.data(), output.pos))
+                        {
+                            stopped = true;
+                            break;
+                        }
+                    }
+                }
+
+                if (err.empty() && raw_failed())
+                    err = "read error";
+                else if (err.empty() && !stopped && pending != 0)
+                    err = "zstd: unexpected end of compressed data";
+
+                ZSTD_freeDStream(ds);
+            }
+        };
+    }
+
+    std::unique_ptr<InputSource> open_input(const std::filesystem::path &path, std::string &error)
+    {
+        error.clear();
+
+        const bool from_stdin = is_stdio_path(path);
+        std::FILE *f = from_stdin ? stdin : std::fopen(path.string().c_str(), "rb");
+        if (!f)
+        {
+            error = "Error, can't open file: " + path.string();
+            return nullptr;
+        }
+
+        // Magic bytes are read (not peeked) so pipes work too; RawFile replays them
+        unsigned char magic[4]{};
+        const std::size_t n = std::fread(magic, 1, sizeof(magic), f);
+        auto raw = std::make_unique<RawFile>(f, !from_stdin, magic, n);
+
+        switch (detect_compression(magic, n))
+        {
+        case Compression::Gzip:
+        {
+            auto src = std::make_unique<GzipSource>(std::move(raw));
+            src->start();
+            return src;
+        }
+        case Compression::Zstd:
+        {
+            auto src = std::make_unique<ZstdSource>(std::move(raw));
+            src->start();
+            return src;
+        }
+        default:
+            return std::make_unique<PlainSource>(std::move(raw));
+        }
+    }
+
+    std::unique_ptr<InputSource> open_input_at(const std::filesystem::path &path, std::uint64_t offset,
+                                               std::string &error)
+    {
+        error.clear();
+
+        if (is_stdio_path(path))
+        {
+            error = "stdin is not seekable";
+            return nullptr;
+        }
+
+        std::FILE *f = std::fopen(path.string().c_str(), "rb");
+        if (!f)
+        {
+            error = "Error, can't open file: " + path.string();
+            return nullptr;
+        }
+
+        unsigned char magic[4]{};
+        const std::size_t n = std::fread(magic, 1, sizeof(magic), f);
+        auto raw = std::make_unique<RawFile>(f, true, nullptr, 0);
+
+        if (detect_compression(magic, n) != Compression::None)
+        {
+            error = "compressed input is not seekable: " + path.string();
+            return nullptr;
+        }
+
+#if defined(_WIN32)
+        const bool seeked = _fseeki64(f, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+        const bool seeked = fseeko(f, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+        if (!seeked)
+        {
+            error = "can't seek in " + path.string();
+            return nullptr;
+        }
+
+        return std::make_unique<PlainSource>(std::move(raw));
+    }
+
+    LineReader::LineReader(InputSource &src, std::size_t buffer_size)
+        : src_(src), buf_(buffer_size < 16 ? 16 : buffer_size)
+    {
+    }
+
+    LineReader::LineReader(InputSource &src, std::vector<char> &&buffer)
+        : src_(src), buf_(std::move(buffer))
+    {
+        if (buf_.size() < 16)
+            buf_.resize(DEFAULT_BUFFER);
+    }
+
+    bool LineReader::next(std::string_view &line)
+    {
+        for (;;)
+        {
+            const char *base = buf_.data();
+            const void *nl = (scan_ < end_) ? std::memchr(base + scan_, '\n', end_ - scan_) : nullptr;
+
+            if (nl)
+            {
+                const std::size_t pos = static_cast<std::size_t>(static_cast<const char *>(nl) - base);
+                line = std::string_view(base + begin_, pos - begin_);
+                line_offset_ = buf_offset_ + begin_;
+                begin_ = scan_ = pos + 1;
+                return true;
+            }
+            scan_ = end_;
+
+            if (eof_)
+            {
+                if (begin_ == end_)
+                    return false;
+
+                // last line without '\n'
+                line = std::string_view(base + begin_, end_ - begin_);
+                line_offset_ = buf_offset_ + begin_;
+                begin_ = scan_ = end_;
+                return true;
+            }
+
+            // keep the unfinished line, make room behind it
+            if (begin_ > 0)
+            {
+                std::memmove(buf_.data(), buf_.data() + begin_, end_ - begin_);
+                buf_offset_ += begin_;
+                end_ -= begin_;
+                scan_ -= begin_;
+                begin_ = 0;
+            }
+
+            // a single line longer than the buffer
+            if (end_ == buf_.size())
+                buf_.resize(buf_.size() * 2);
+
+            const std::size_t n = src_.read(buf_.data() + end_, buf_.size() - end_);
+            if (n == 0)
+                eof_ = true;
+            end_ += n;
+        }
+    }
+
+}
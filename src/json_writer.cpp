@@ -0,0 +1,177 @@
+#include "sla/json_writer.hpp"
+#include "sla/util.hpp"   // utf8_sequence_length
+
+#include <nlohmann/json.hpp>   // nlohmann::detail::to_chars, the float format of dump()
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+namespace sla
+{
+    JsonWriter::JsonWriter(std::string &out, int indent)
+        : out_(out), indent_(indent > 0 ? static_cast<std::size_t>(indent) : 0)
+    {
+    }
+
+    // separator and indentation before an array element or object key
+    void JsonWriter::prefix()
+    {
+        if (after_key_)
+        {
+            after_key_ = false;
+            return;
+        }
+        if (stack_.empty())
+            return;
+
+        if (stack_.back().count++ > 0)
+            out_ += ',';
+        out_ += '\n';
+        out_.append(indent_ * stack_.size(), ' ');
+    }
+
+    void JsonWriter::begin_object()
+    {
+        prefix();
+        out_ += '{';
+        stack_.push_back({});
+    }
+
+    void JsonWriter::begin_array()
+    {
+        prefix();
+        out_ += '[';
+        stack_.push_back({});
+    }
+
+    // empty containers stay on one line: {} and []
+    void JsonWriter::end_object()
+    {
+        const bool empty = stack_.back().count == 0;
+        stack_.pop_back();
+        if (!empty)
+        {
+            out_ += '\n';
+            out_.append(indent_ * stack_.size(), ' ');
+        }
+        out_ += '}';
+    }
+
+    void JsonWriter::end_array()
+    {
+        const bool empty = stack_.back().count == 0;
+        stack_.pop_back();
+        if (!empty)
+        {
+            out_ += '\n';
+            out_.append(indent_ * stack_.size(), ' ');
+        }
+        out_ += ']';
+    }
+
+    void JsonWriter::key(std::string_view k)
+    {
+        prefix();
+        write_string(k);
+        out_ += ": ";
+        after_key_ = true;
+    }
+
+    void JsonWriter::value(std::string_view s)
+    {
+        prefix();
+        write_string(s);
+    }
+
+    void JsonWriter::value(bool b)
+    {
+        prefix();
+        out_ += b ? "true" : "false";
+    }
+
+    void JsonWriter::value(std::nullptr_t)
+    {
+        prefix();
+        out_ += "null";
+    }
+
+    void JsonWriter::value(double d)
+    {
+        prefix();
+        if (!std::isfinite(d))
+        {
+            out_ += "null";
+            return;
+        }
+
+        std::array<char, 64> buf;
+        const char *end = nlohmann::detail::to_chars(buf.data(), buf.data() + buf.size(), d);
+        out_.append(buf.data(), static_cast<std::size_t>(end - buf.data()));
+    }
+
+    void JsonWriter::write_integer(std::int64_t v)
+    {
+        prefix();
+        std::array<char, 24> buf;
+        const auto r = std::to_chars(buf.data(), buf.data() + buf.size(), v);
+        out_.append(buf.data(), static_cast<std::size_t>(r.ptr - buf.data()));
+    }
+
+    void JsonWriter::write_integer(std::uint64_t v)
+    {
+        prefix();
+        std::array<char, 24> buf;
+        const auto r = std::to_chars(buf.data(), buf.data() + buf.size(), v);
+        out_.append(buf.data(), static_cast<std::size_t>(r.ptr - buf.data()));
+    }
+
+    void JsonWriter::write_string(std::string_view s)
+    {
+        static constexpr char hex[] = "0123456789abcdef";
+
+        out_ += '"';
+        for (std::size_t i = 0; i < s.size();)
+        {
+            const auto c = static_cast<unsigned char>(s[i]);
+            if (c >= 0x80)
+            {
+                const std::size_t n = utf8_sequence_length(s, i);
+                if (n == 0)
+                {
+                    throw std::runtime_error("invalid UTF-8 byte at index " + std::to_string(i) + ": 0x" +
+                                             std::string{"0123456789ABCDEF"[c >> 4], "0123456789ABCDEF"[c & 15]});
+                }
+                out_.append(s.data() + i, n);
+                i += n;
+                continue;
+            }
+
+            switch (c)
+            {
+            case '"': out_ += "\\\""; break;
+            case '\\': out_ += "\\\\"; break;
+            case '\b': out_ += "\\b"; break;
+            case '\f': out_ += "\\f"; break;
+            case '\n': out_ += "\\n"; break;
+            case '\r': out_ += "\\r"; break;
+            case '\t': out_ += "\\t"; break;
+            default:
+                if (c < 0x20)
+                {
+                    out_ += "\\u00";
+                    out_ += hex[c >> 4];
+                    out_ += hex[c & 15];
+                }
+                else
+                {
+                    out_ += static_cast<char>(c);
+                }
+            }
+            ++i;
+        }
+        out_ += '"';
+    }
+
+}
@@ -4,12 +4,21 @@
 #include "sla/time_axis.hpp"
 #include "sla/report.hpp"
 #include "sla/writer.hpp"
+#include "sla/synth.hpp"
+#include "sla/reorder.hpp"
+#include "sla/resample.hpp"
+#include "sla/allan.hpp"
+#include "sla/apply.hpp"
+#include "sla/hampel.hpp"
+#include "sla/input_source.hpp"
 #include "sla/cli.hpp"
 #include "sla/csv.hpp"
+#include "sla/rejects.hpp"
 
 #include <system_error>
 #include <fmt/core.h>
 #include <filesystem>
+#include <optional>
 #include <variant>
 #include <chrono>
 #include <string>
@@ -48,18 +57,256 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if (opt.cmd == sla::cli::Command::Gen)
+    {
+        // generated data may go to stdout
+        std::FILE *msg = sla::is_stdio_path(opt.output_file) ? stderr : stdout;
+
+        sla::SynthOptions gen_opt = opt.gen;
+
+        if (!opt.position_file.empty())
+        {
+            std::string pos_error;
+            gen_opt.positions = sla::read_position(opt.position_file, pos_error);
+            if (!pos_error.empty())
+            {
+                fmt::println(stderr, "Error: {}", pos_error);
+                return 1;
+            }
+        }
+
+        const auto t0 = std::chrono::steady_clock::now();
+        auto r = sla::write_synthetic_csv(gen_opt, opt.output_file);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - t0;
+
+        if (!r.ok)
+        {
+            fmt::println(stderr, "Error: {}", r.error);
+            return 1;
+        }
+
+        const double secs = elapsed.count() > 0.0 ? elapsed.count() : 1e-9;
+        fmt::println(msg, "Generated file: {}", opt.output_file);
+        fmt::println(msg, "rows = {}, malformed lines = {}, bytes = {}", r.rows, r.malformed_lines, r.bytes);
+        fmt::println(msg, "{:.3f} s, {:.1f} MB/s", secs, static_cast<double>(r.bytes) / secs / 1e6);
+        return 0;
+    }
+
+    if (opt.cmd == sla::cli::Command::Resample)
+    {
+        sla::ResampleOptions rs_opt = opt.resample;
+        rs_opt.input_path = opt.input_file;
+
+        if (!opt.output_file.empty())
+            rs_opt.output_path = opt.output_file;
+        else
+            rs_opt.output_path = sla::is_stdio_path(opt.input_file)
+                ? std::filesystem::path("-")
+                : sla::make_resample_path(opt.input_file);
+
+        std::FILE *msg = sla::is_stdio_path(rs_opt.output_path) ? stderr : stdout;
+
+        auto r = sla::run_resample(rs_opt);
+
+        if (!r.ok)
+        {
+            fmt::println(stderr, "Resample error: {}", r.error);
+            return 1;
+        }
+
+        fmt::println(msg, "Resampled file: {}", rs_opt.output_path.string());
+        fmt::println(msg, "input rows = {}, output rows = {} at {} Hz", r.counts.parsed_lines, r.rows_out, rs_opt.rate_hz);
+        fmt::println(msg, "gaps = {}, grid points skipped = {}, non-increasing rows skipped = {}",
+                     r.gaps, r.grid_points_skipped, r.rows_skipped);
+        return 0;
+    }
+
+    if (opt.cmd == sla::cli::Command::Apply)
+    {
+        sla::ApplyOptions ap_opt;
+        ap_opt.input_path = opt.input_file;
+        ap_opt.coeffs_path = opt.coeffs_file;
+
+        if (!opt.output_file.empty())
+            ap_opt.output_path = opt.output_file;
+        else
+            ap_opt.output_path = sla::is_stdio_path(opt.input_file)
+                ? std::filesystem::path("-")
+                : sla::make_calib_path(opt.input_file);
+
+        std::FILE *msg = sla::is_stdio_path(ap_opt.output_path) ? stderr : stdout;
+
+        const auto t0 = std::chrono::steady_clock::now();
+        auto r = sla::run_apply(ap_opt);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - t0;
+
+        if (!r.ok)
+        {
+            fmt::println(stderr, "Apply error: {}", r.error);
+            return 1;
+        }
+
+        fmt::println(msg, "Corrected file: {}", ap_opt.output_path.string());
+        fmt::println(msg, "rows = {}, kernel = {}, {:.3f} s",
+                     r.rows_out, sla::correction_kernel_is_avx2() ? "avx2" : "scalar", elapsed.count());
+        return 0;
+    }
+
+    if (opt.cmd == sla::cli::Command::Allan)
+    {
+        sla::AllanOptions al_opt = opt.allan;
+        al_opt.input_path = opt.input_file;
+
+        if (!opt.output_file.empty())
+            al_opt.output_path = opt.output_file;
+        else
+            al_opt.output_path = sla::is_stdio_path(opt.input_file)
+                ? std::filesystem::path("-")
+                : sla::make_allan_path(opt.input_file);
+
+        std::FILE *msg = sla::is_stdio_path(al_opt.output_path) ? stderr : stdout;
+
+        const auto t0 = std::chrono::steady_clock::now();
+        auto r = sla::run_allan(al_opt);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - t0;
+
+        std::string write_error;
+        if (r.ok && !sla::write_allan_result(r, al_opt.output_path, write_error))
+        {
+            r.ok = false;
+            r.error = write_error;
+        }
+
+        if (!r.ok)
+        {
+            fmt::println(stderr, "Allan error: {}", r.error);
+            return 1;
+        }
+
+        fmt::println(msg, "Allan deviation: {}", al_opt.output_path.string());
+        fmt::println(msg, "rows = {}, tau0 = {:.6f} s, taus = {}, {:.3f} s",
+                     r.counts.parsed_lines, r.tau0_s, r.points.size(), elapsed.count());
+        return 0;
+    }
+
+    if (opt.cmd == sla::cli::Command::Calib && opt.sweep)
+    {
+        sla::SweepOptions sw_opt = opt.sweep_opt;
+        sw_opt.input_path = opt.input_file;
+        sw_opt.position_path = opt.position_file.empty()
+            ? (std::filesystem::path(opt.input_file).parent_path() / "POSITION.txt")
+            : std::filesystem::path(opt.position_file);
+        sw_opt.output_path = opt.output_file.empty()
+            ? sla::make_sweep_path(opt.input_file)
+            : std::filesystem::path(opt.output_file);
+
+        std::FILE *msg = sla::is_stdio_path(sw_opt.output_path) ? stderr : stdout;
+
+        const auto t0 = std::chrono::steady_clock::now();
+        auto r = sla::run_calibration_sweep(sw_opt);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - t0;
+
+        std::string write_error;
+        if (r.ok && !sla::write_sweep_csv(r, sw_opt.output_path, write_error))
+        {
+            r.ok = false;
+            r.error = write_error;
+        }
+
+        if (!r.ok)
+        {
+            fmt::println(stderr, "Calibration sweep error: {}", r.error);
+            return 1;
+        }
+
+        const auto &best = r.windows[r.best];
+        fmt::println(msg, "Calibration sweep: {}", sw_opt.output_path.string());
+        fmt::println(msg, "parsed_lines = {}, npos = {}, L = {}, chunk = {} rows, windows = {}, {:.3f} s",
+                     r.parsed_lines, r.npos, r.L, r.chunk_rows, r.windows.size(), elapsed.count());
+        fmt::println(msg, "best steady window: [{:.3f}, {:.3f}) fit_rms = {:.6f} mag_err_max = {:.6f} noise_std_max = {:.6f}",
+                     best.start_frac, best.end_frac, best.fit_rms, best.mag_err_max, best.noise_std_max);
+        return 0;
+    }
+
+    if (opt.cmd == sla::cli::Command::Calib && !opt.batch_dir.empty())
+    {
+        sla::BatchOptions b_opt;
+        b_opt.dir = opt.batch_dir;
+        b_opt.position_path = opt.position_file.empty()
+            ? (b_opt.dir / "POSITION.txt")
+            : std::filesystem::path(opt.position_file);
+        b_opt.summary_path = opt.output_file.empty()
+            ? sla::make_batch_summary_path(b_opt.dir)
+            : std::filesystem::path(opt.output_file);
+        b_opt.threads = opt.sweep_opt.threads;
+        b_opt.max_residual = opt.max_residual;
+        b_opt.calib.auto_steady = opt.steady;
+        b_opt.calib.bootstrap = opt.bootstrap;
+        b_opt.calib.cache_dir = opt.cache_dir;
+
+        std::FILE *msg = sla::is_stdio_path(b_opt.summary_path) ? stderr : stdout;
+
+        const auto t0 = std::chrono::steady_clock::now();
+        auto r = sla::run_calibration_batch(b_opt);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - t0;
+
+        for (const auto &s : r.skipped)
+            fmt::println(stderr, "Skipped {}: {}", s.input.filename().string(), s.reason);
+
+        std::string write_error;
+        if (r.ok && !sla::write_batch_summary(r, b_opt.summary_path, write_error))
+        {
+            r.ok = false;
+            r.error = write_error;
+        }
+
+        if (!r.ok)
+        {
+            fmt::println(stderr, "Calibration batch error: {}", r.error);
+            return 1;
+        }
+
+        for (const auto &d : r.devices)
+        {
+            if (!d.pass)
+                fmt::println(msg, "FAIL {}: {}", d.input.filename().string(),
+                             d.result.ok ? fmt::format("fit residual {:.6f}", d.result.fit_residual_max) : d.result.error);
+        }
+        fmt::println(msg, "Calibration batch: {}", b_opt.summary_path.string());
+        fmt::println(msg, "devices = {}, pass = {}, fail = {}, {:.3f} s",
+                     r.devices.size(), r.passed, r.devices.size() - r.passed, elapsed.count());
+
+        // the summary is written either way; the exit code tells the line whether all passed
+        return r.passed == r.devices.size() ? 0 : 2;
+    }
+
     const bool do_clean = (opt.cmd == sla::cli::Command::Clean);
     const bool do_calib = (opt.cmd == sla::cli::Command::Calib);
+    const bool from_stdin = sla::is_stdio_path(opt.input_file);
 
     std::filesystem::path clean_final_path;
     std::filesystem::path clean_tmp_path;
+    bool clean_to_stdout = false;
 
     sla::CsvWriter writer;
+    sla::RejectWriter rejects;
 
     if (do_clean)
     {
-        clean_final_path = sla::make_clean_path(opt.input_file);
-        clean_tmp_path = make_tmp_sibling(clean_final_path);
+        if (!opt.output_file.empty())
+            clean_final_path = opt.output_file;
+        else
+            clean_final_path = from_stdin ? std::filesystem::path("-") : sla::make_clean_path(opt.input_file);
+
+        if (!opt.rejects_file.empty() && !rejects.open(opt.rejects_file))
+        {
+            fmt::println(stderr, "Error: can't open file for writing: {}", opt.rejects_file);
+            return 1;
+        }
+
+        // stdout can't be renamed into place: write it directly
+        clean_to_stdout = sla::is_stdio_path(clean_final_path);
+        clean_tmp_path = clean_to_stdout ? clean_final_path : make_tmp_sibling(clean_final_path);
 
         if (!writer.open( clean_tmp_path)) // Open file for writing
         {
@@ -81,6 +328,9 @@ int main(int argc, char *argv[])
             ? (input_dir / "POSITION.txt")
             : std::filesystem::path(opt.position_file);
         calib_opt.output_path = calib_output_path;
+        calib_opt.auto_steady = opt.steady;
+        calib_opt.bootstrap = opt.bootstrap;
+        calib_opt.cache_dir = opt.cache_dir;
 
         auto r = sla::run_calibration(calib_opt);
 
@@ -92,7 +342,10 @@ int main(int argc, char *argv[])
 
         fmt::println("Calibrated file: {}", calib_output_path.string());
         fmt::println("parsed_lines = {}", r.parsed_lines);
-        fmt::println("npos={} L={} steady=[{}, {})", r.npos, r.L, r.steady_start, r.steady_end);
+        if (opt.steady.window > 0)
+            fmt::println("npos={} steady segments detected={}", r.npos, r.steady_segments);
+        else
+            fmt::println("npos={} L={} steady=[{}, {})", r.npos, r.L, r.steady_start, r.steady_end);
 
         fmt::println("Raw(all)   max(|mag-g|) = {:.6f}", r.max_abs_mag_raw_all);
         fmt::println("Raw(steady) max(|mag-g|) = {:.6f}", r.max_abs_mag_raw_steady);
@@ -113,31 +366,137 @@ int main(int argc, char *argv[])
         fmt::println("[{:.6f} {:.6f} {:.6f}]", r.C.a[0][0], r.C.a[0][1], r.C.a[0][2]);
         fmt::println("[{:.6f} {:.6f} {:.6f}]", r.C.a[1][0], r.C.a[1][1], r.C.a[1][2]);
         fmt::println("[{:.6f} {:.6f} {:.6f}]", r.C.a[2][0], r.C.a[2][1], r.C.a[2][2]);
-        
+
+        if (r.bootstrap.replicates > 0)
+        {
+            const auto &se = r.bootstrap.spread.se;
+            fmt::println("Bootstrap: {} replicates ({} failed), standard errors in {}",
+                         r.bootstrap.replicates, r.bootstrap.failed, calib_output_path.stem().string() + ".json");
+            fmt::println("se(diag M)=({:.2e},{:.2e},{:.2e}) se(b)=({:.2e},{:.2e},{:.2e})",
+                         se[0], se[4], se[8], se[9], se[10], se[11]);
+        }
+
         return 0;
     }
 
+    // Report: --report, else next to the input. From stdin: analyze prints it
+    // to stdout, clean (whose data may already be on stdout) skips it
+    std::filesystem::path json_path;
+    if (!opt.report_file.empty())
+        json_path = opt.report_file;
+    else if (!from_stdin)
+        json_path = sla::default_report_json_path(opt.input_file);
+    else if (!do_clean)
+        json_path = "-";
+
+    // status text must not end up inside data written to stdout
+    std::FILE *msg = (clean_to_stdout || sla::is_stdio_path(json_path)) ? stderr : stdout;
+
+    // Single pass: statistics, time axis and clean output together,
+    // so the input may be a pipe
     sla::WelfordStats ax, ay, az;
+    sla::TimeAxisAccumulator time_axis;
 
-    auto pass1 = sla::read_imu_csv_streaming(opt.input_file,
-    // lambda
-    [&](const std::array<double, 4> &row)
+    std::optional<sla::WelchPsd> psd;
+    if (opt.psd_window > 0)
+        psd.emplace(static_cast<std::size_t>(opt.psd_window));
+
+    auto update_stats = [&](const std::array<double, 4> &row)
     {
         ax.update(row[1]);
         ay.update(row[2]);
         az.update(row[3]);
 
-        if (do_clean)
+        if (psd)
+            psd->update(row[1], row[2], row[3]);
+    };
+
+    // clean pipeline: input -> [reorder] -> [hampel] -> writer
+    std::optional<sla::HampelFilter> hampel;
+    std::optional<sla::ReorderBuffer> reorder;
+
+    if (do_clean && opt.hampel.half_window > 0)
+    {
+        // the outliers are what would pollute the statistics: take them after the filter
+        hampel.emplace(opt.hampel, [&](const std::array<double, 4> &row)
+        {
+            update_stats(row);
+            writer.write_row(row);
+        });
+    }
+
+    if (do_clean && opt.reorder_window > 0)
+    {
+        reorder.emplace(static_cast<std::size_t>(opt.reorder_window), opt.dedup,
+                        [&](const std::array<double, 4> &row)
+        {
+            if (hampel)
+                hampel->push(row);
+            else
+                writer.write_row(row);
+        });
+    }
+
+    auto pass1 = sla::read_imu_csv_streaming_located(opt.input_file,
+    // lambda
+    [&](const std::array<double, 4> &row, const sla::RowLocation &loc)
+    {
+        time_axis.update(row[0], loc.line, loc.byte_offset);
+
+        if (!hampel)
+            update_stats(row);
+
+        if (reorder)
+        {
+            reorder->push(row);
+        }
+        else if (hampel)
+        {
+            hampel->push(row);
+        }
+        else if (do_clean)
         {
             writer.write_row(row);
         }
+    },
+    [&](const sla::RejectedLine &bad)
+    {
+        if (rejects.is_open())
+            rejects.write(bad);
     });
 
     if (do_clean)
     {
+        if (reorder)
+            reorder->flush();
+
+        if (hampel)
+            hampel->flush();
+
         writer.close();
 
-        if (!pass1.ok)
+        if (!writer.ok())
+        {
+            fmt::println(stderr, "Error: can't write clean file: {}", clean_tmp_path.string());
+            return 1;
+        }
+
+        if (rejects.is_open())
+        {
+            rejects.close();
+            if (!rejects.ok())
+            {
+                fmt::println(stderr, "Error: can't write rejects file: {}", opt.rejects_file);
+                return 1;
+            }
+            fmt::println(msg, "Rejects file: {} ({} lines)", opt.rejects_file, rejects.rejects());
+        }
+
+        if (clean_to_stdout)
+        {
+            // nothing to finalize
+        }
+        else if (!pass1.ok)
         {
             fmt::println(stderr, 
                 "Warning: clean failed; keeping temp file: {}", 
@@ -171,7 +530,7 @@ int main(int argc, char *argv[])
                 }
             }
 
-            fmt::println("Clean file: {}", clean_final_path.string());
+            fmt::println(msg, "Clean file: {}", clean_final_path.string());
         }
     }
 
@@ -187,7 +546,7 @@ int main(int argc, char *argv[])
         if (w.count() == 0)
             return s;
         
-        s.count = static_cast<int>(w.count());
+        s.count = w.count();
         s.min = w.min();
         s.max = w.max();
         s.mean = w.mean();
@@ -202,47 +561,83 @@ int main(int argc, char *argv[])
     report.counts = pass1.counts;
     report.warnings = pass1.warnings;
     report.warnings_dropped = pass1.warnings_dropped;
+    report.warning_categories = pass1.warning_categories;
 
-    report.time_axis = sla::make_time_axis_report_streaming(
-        [&](const sla::TimestampVisitor &visit)
-        {
-            (void)sla::read_imu_csv_streaming(opt.input_file,
-                [&](const std::array<double, 4> &row)
-                {
-                    visit(row[0]);
-                });
-        });
+    report.time_axis = time_axis.report();
 
     report.statistics.ax = to_stats(ax);
     report.statistics.ay = to_stats(ay);
     report.statistics.az = to_stats(az);
-    
-    auto json_path = sla::default_report_json_path(pass1.input_path);
 
-    try
+    if (reorder)
+        report.reorder = reorder->stats();
+
+    if (hampel)
     {
-        sla::write_report_json_file(report, json_path);
-        fmt::println("Report written to: {}", json_path.string());
+        report.counts.outliers = hampel->stats().outliers;
+        report.counts.outlier_rows_dropped = hampel->stats().rows_dropped;
+        report.counts.outlier_values_replaced = hampel->stats().values_replaced;
     }
-    catch(const std::exception& e)
+
+    // fs from the time axis (1000 / median dt)
+    if (psd)
+        report.psd = psd->report(report.time_axis.sampling_hz_est);
+
+    if (!json_path.empty())
     {
-        fmt::println(stderr, "Error writing JSON: {}", e.what());
-        return 1;
+        try
+        {
+            sla::write_report_json_file(report, json_path);
+            if (!sla::is_stdio_path(json_path))
+                fmt::println(msg, "Report written to: {}", json_path.string());
+        }
+        catch(const std::exception& e)
+        {
+            fmt::println(stderr, "Error writing JSON: {}", e.what());
+            return 1;
+        }
     }
 
-    fmt::println("\n=== Analysis Summary ===");
-    fmt::println("Input file: {}", report.input);
-    fmt::println("Total lines: {}", report.counts.total_lines);
-    fmt::println("Parsed lines: {}", report.counts.parsed_lines);
-    fmt::println("Bad lines: {}", report.counts.bad_lines);
-    fmt::println("Warnings: {}", report.warnings.size());
+    fmt::println(msg, "\n=== Analysis Summary ===");
+    fmt::println(msg, "Input file: {}", report.input);
+    fmt::println(msg, "Total lines: {}", report.counts.total_lines);
+    fmt::println(msg, "Parsed lines: {}", report.counts.parsed_lines);
+    fmt::println(msg, "Bad lines: {}", report.counts.bad_lines);
+    fmt::println(msg, "Warnings: {}", report.warnings.size());
+    for (const auto &c : report.warning_categories)
+    {
+        if (c.kind == sla::WarningKind::InvalidValue)
+            fmt::println(msg, "  {} in column {}: {} (lines {}..{})", c.message(), c.detail, c.count, c.first_line, c.last_line);
+        else
+            fmt::println(msg, "  {}: {} (lines {}..{})", c.message(), c.count, c.first_line, c.last_line);
+    }
+
+    if (hampel)
+    {
+        fmt::println(msg, "Outliers: {} (rows dropped {}, values replaced {})", report.counts.outliers,
+                     report.counts.outlier_rows_dropped, report.counts.outlier_values_replaced);
+    }
 
     if (report.time_axis.dt_available)
     {
-        fmt::println("\nSampling frequency: {:.2f} Hz", report.time_axis.sampling_hz_est);
-        fmt::println("Time interval stats (ms):");
-        fmt::println("  mean: {:.3f}", report.time_axis.dt_ms.mean);
-        fmt::println("  std:  {:.3f}", report.time_axis.dt_ms.std);
+        fmt::println(msg, "\nSampling frequency: {:.2f} Hz", report.time_axis.sampling_hz_est);
+        fmt::println(msg, "Time interval stats (ms):");
+        fmt::println(msg, "  mean: {:.3f}", report.time_axis.dt_ms.mean);
+        fmt::println(msg, "  std:  {:.3f}", report.time_axis.dt_ms.std);
+        fmt::println(msg, "  median: {:.3f}", report.time_axis.dt_median_ms);
+    }
+
+    if (report.psd)
+    {
+        fmt::println(msg, "\nPSD: window {}, {} segments, fs = {:.2f} Hz",
+                     report.psd->window, report.psd->segments, report.psd->fs_hz);
+    }
+
+    if (report.reorder)
+    {
+        fmt::println(msg, "\nReorder (window {}): reordered {}, duplicates dropped {}, late dropped {}",
+                     report.reorder->window, report.reorder->reordered,
+                     report.reorder->duplicates_dropped, report.reorder->late_dropped);
     }
 
     return 0;
@@ -0,0 +1,98 @@
+#include "sla/psd.hpp"
+
+#include <cmath>
+#include <numbers>
+
+
+namespace sla
+{
+
+    WelchPsd::WelchPsd(std::size_t window)
+        : n_(window), fft_(window), hann_(window),
+          seg_(window), re_(window / 2 + 1), im_(window / 2 + 1)
+    {
+        // periodic Hann: overlapping at 50% sums to a constant
+        for (std::size_t i = 0; i < n_; ++i)
+        {
+            hann_[i] = 0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(n_));
+            hann_power_ += hann_[i] * hann_[i];
+        }
+
+        for (int a = 0; a < 3; ++a)
+        {
+            ring_[a].assign(n_, 0.0);
+            acc_[a].assign(n_ / 2 + 1, 0.0);
+        }
+    }
+
+    void WelchPsd::update(double ax, double ay, double az)
+    {
+        ring_[0][head_] = ax;
+        ring_[1][head_] = ay;
+        ring_[2][head_] = az;
+        head_ = (head_ + 1) % n_;
+        filled_++;
+        since_last_++;
+
+        if (filled_ >= n_ && (filled_ == n_ || since_last_ >= n_ / 2))
+        {
+            process_segment();
+            since_last_ = 0;
+        }
+    }
+
+    void WelchPsd::process_segment()
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            // oldest sample is at head_
+            double mean = 0.0;
+            for (std::size_t i = 0; i < n_; ++i)
+            {
+                seg_[i] = ring_[a][(head_ + i) % n_];
+                mean += seg_[i];
+            }
+            mean /= static_cast<double>(n_);
+
+            for (std::size_t i = 0; i < n_; ++i)
+                seg_[i] = (seg_[i] - mean) * hann_[i];
+
+            fft_.forward(seg_.data(), re_.data(), im_.data());
+
+            auto &acc = acc_[a];
+            for (std::size_t k = 0; k <= n_ / 2; ++k)
+                acc[k] += re_[k] * re_[k] + im_[k] * im_[k];
+        }
+        segments_++;
+    }
+
+    PsdReport WelchPsd::report(double fs_hz) const
+    {
+        PsdReport r;
+        r.window = n_;
+        r.segments = segments_;
+        r.fs_hz = fs_hz;
+
+        if (segments_ == 0 || !(fs_hz > 0.0))
+            return r;
+
+        const std::size_t bins = n_ / 2 + 1;
+        r.freq_hz.resize(bins);
+        for (std::size_t k = 0; k < bins; ++k)
+            r.freq_hz[k] = static_cast<double>(k) * fs_hz / static_cast<double>(n_);
+
+        // one-sided density: |X|^2 / (fs * sum w^2), doubled except at DC and Nyquist
+        const double scale = 1.0 / (fs_hz * hann_power_ * static_cast<double>(segments_));
+        for (int a = 0; a < 3; ++a)
+        {
+            r.psd[a].resize(bins);
+            for (std::size_t k = 0; k < bins; ++k)
+            {
+                const double one_sided = (k == 0 || k == bins - 1) ? 1.0 : 2.0;
+                r.psd[a][k] = acc_[a][k] * scale * one_sided;
+            }
+        }
+        return r;
+    }
+
+}
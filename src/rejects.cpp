@@ -0,0 +1,140 @@
+#include "sla/rejects.hpp"
+#include "sla/input_source.hpp"   // is_stdio_path
+
+#include <array>
+#include <charconv>
+#include <string_view>
+#include <utility>
+
+namespace sla
+{
+    RejectWriter::~RejectWriter()
+    {
+        close();
+    }
+
+    bool RejectWriter::open(const std::filesystem::path &path)
+    {
+        close();
+
+        if (is_stdio_path(path) || !out_.open(path))
+            return false;
+
+        out_.write("line,reason,raw\n");
+
+        done_ = false;
+        failed_ = false;
+        rejects_ = 0;
+        fill_.reserve(CHUNK);
+
+        worker_ = std::thread([this]() { run(); });
+        return true;
+    }
+
+    static void append(std::vector<char> &buf, std::string_view s)
+    {
+        buf.insert(buf.end(), s.begin(), s.end());
+    }
+
+    // RFC 4180 field body: quotes doubled (the caller adds the enclosing quotes)
+    static void append_escaped(std::vector<char> &buf, std::string_view s)
+    {
+        for (char c : s)
+        {
+            if (c == '"')
+                buf.push_back('"');
+            buf.push_back(c);
+        }
+    }
+
+    void RejectWriter::write(const RejectedLine &r)
+    {
+        std::array<char, 24> num;
+        auto res = std::to_chars(num.data(), num.data() + num.size(), r.line);
+        append(fill_, std::string_view(num.data(), static_cast<std::size_t>(res.ptr - num.data())));
+        fill_.push_back(',');
+
+        // reason and raw are always quoted: the column count messages contain a comma
+        fill_.push_back('"');
+        append_escaped(fill_, warning_message(r.kind, r.detail));
+        if (r.kind == WarningKind::InvalidValue)
+        {
+            append(fill_, " in column ");
+            res = std::to_chars(num.data(), num.data() + num.size(), r.detail);
+            append(fill_, std::string_view(num.data(), static_cast<std::size_t>(res.ptr - num.data())));
+        }
+        append(fill_, "\",\"");
+
+        append_escaped(fill_, r.text);
+        append(fill_, "\"\n");
+
+        rejects_++;
+        if (fill_.size() >= CHUNK)
+            push();
+    }
+
+    void RejectWriter::push()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_);
+            cv_.wait(lock, [&]() { return queue_.size() < MAX_QUEUED; });
+            queue_.push_back(std::move(fill_));
+        }
+        cv_.notify_all();
+
+        // fill_ was moved into the queue; start a fresh one
+        fill_ = std::vector<char>();
+        fill_.reserve(CHUNK);
+    }
+
+    // Writer thread: drains the queue until close() marks it done
+    void RejectWriter::run()
+    {
+        for (;;)
+        {
+            std::vector<char> chunk;
+            {
+                std::unique_lock<std::mutex> lock(m_);
+                cv_.wait(lock, [&]() { return !queue_.empty() || done_; });
+
+                if (queue_.empty())
+                    break;
+
+                chunk = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            cv_.notify_all();
+
+            out_.write(std::string_view(chunk.data(), chunk.size()));
+        }
+
+        out_.close();
+
+        std::lock_guard<std::mutex> lock(m_);
+        failed_ = !out_.ok();
+    }
+
+    void RejectWriter::close()
+    {
+        if (!worker_.joinable())
+            return;
+
+        if (!fill_.empty())
+            push();
+
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            done_ = true;
+        }
+        cv_.notify_all();
+
+        worker_.join();
+    }
+
+    bool RejectWriter::ok() const
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        return !failed_;
+    }
+
+}
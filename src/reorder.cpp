@@ -0,0 +1,85 @@
+#include "sla/reorder.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace sla
+{
+
+    // std heap functions build a max-heap: "less" here means "comes out later"
+    static constexpr auto later = [](const auto &a, const auto &b)
+    {
+        if (a.row[0] != b.row[0])
+            return a.row[0] > b.row[0];
+        return a.seq > b.seq;
+    };
+
+    ReorderBuffer::ReorderBuffer(std::size_t window, bool drop_duplicates, Emit emit)
+        : window_(window), drop_duplicates_(drop_duplicates), emit_(std::move(emit))
+    {
+        stats_.window = window;
+        heap_.reserve(window + 1);
+    }
+
+    void ReorderBuffer::push(const Row &row)
+    {
+        const double t = row[0];
+
+        if (have_emitted_ && t < last_emitted_t_)
+        {
+            stats_.late_dropped++;
+            return;
+        }
+
+        const bool displaced = have_max_ && t < max_t_seen_;
+        if (!have_max_ || t > max_t_seen_)
+        {
+            max_t_seen_ = t;
+            have_max_ = true;
+        }
+
+        heap_.push_back(Pending{row, seq_++, displaced});
+        std::push_heap(heap_.begin(), heap_.end(), later);
+
+        if (heap_.size() > window_)
+            pop_one();
+    }
+
+    void ReorderBuffer::flush()
+    {
+        while (!heap_.empty())
+            pop_one();
+    }
+
+    void ReorderBuffer::pop_one()
+    {
+        std::pop_heap(heap_.begin(), heap_.end(), later);
+        const Pending p = heap_.back();
+        heap_.pop_back();
+
+        const double t = p.row[0];
+
+        if (!have_emitted_ || t != last_emitted_t_)
+        {
+            emitted_at_last_t_.clear();
+            last_emitted_t_ = t;
+            have_emitted_ = true;
+        }
+        else if (drop_duplicates_ &&
+                 std::find(emitted_at_last_t_.begin(), emitted_at_last_t_.end(), p.row) != emitted_at_last_t_.end())
+        {
+            stats_.duplicates_dropped++;
+            return;
+        }
+
+        // bounded too: a file stuck on one timestamp must not grow this
+        if (drop_duplicates_ && emitted_at_last_t_.size() <= window_)
+            emitted_at_last_t_.push_back(p.row);
+
+        if (p.displaced)
+            stats_.reordered++;
+
+        emit_(p.row);
+    }
+
+}
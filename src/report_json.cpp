@@ -1,6 +1,9 @@
 #include "sla/report_json.hpp"
+#include "sla/input_source.hpp"   // is_stdio_path
+#include "sla/writer.hpp"         // strip_compression_extension
 
 #include <fstream>
+#include <iostream>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -38,6 +41,33 @@ static nlohmann::ordered_json warning_to_json(const Warning &w)
     return j;
 }
 
+// {"message": "invalid value", "kind": "invalid_value", "column": 2, "count": 512,
+//  "first_line": 14, "last_line": 98211, "samples": [{"line": 14, "text": "abc"}, ...]}
+static nlohmann::ordered_json warning_category_to_json(const WarningCategory &c)
+{
+    const bool columns = c.kind == WarningKind::ColumnCount;
+
+    nlohmann::ordered_json j{
+        {"message", c.message()},
+        {"kind", columns ? "column_count" : "invalid_value"},
+        {columns ? "columns" : "column", c.detail},
+        {"count", c.count},
+        {"first_line", c.first_line},
+        {"last_line", c.last_line},
+        {"samples", nlohmann::ordered_json::array()}};
+
+    for (std::size_t i = 0; i < c.sample_count; ++i)
+    {
+        const auto &s = c.samples[i];
+        nlohmann::ordered_json js{{"line", s.line}, {"text", s.text()}};
+        if (s.truncated)
+            js["truncated"] = true;
+        j["samples"].push_back(std::move(js));
+    }
+
+    return j;
+}
+
 static nlohmann::ordered_json counts_to_json(const Counts &c)
 {
     return nlohmann::ordered_json{
@@ -47,9 +77,26 @@ static nlohmann::ordered_json counts_to_json(const Counts &c)
         {"header_lines", c.header_lines},
         {"parsed_lines", c.parsed_lines},
         {"bad_lines", c.bad_lines},
+        {"outliers", c.outliers},
+        {"outlier_rows_dropped", c.outlier_rows_dropped},
+        {"outlier_values_replaced", c.outlier_values_replaced},
     };
 }
 
+// {"kind": "gap", "row": 41, "line": 43, "byte_offset": 1187, "t_before": 400.0, ...}
+static nlohmann::ordered_json event_to_json(const TimeAxisEvent &e)
+{
+    return nlohmann::ordered_json{
+        {"kind", to_string(e.kind)},
+        {"row", e.row},
+        {"line", e.line},
+        {"byte_offset", e.byte_offset},
+        {"t_before", e.t_before},
+        {"t_after", e.t_after},
+        {"dt", e.dt},
+        {"count", e.count}};
+}
+
 static nlohmann::ordered_json time_axis_to_json(const TimeAxisReport &t)
 {
     // Initialize an empty ordered JSON
@@ -60,11 +107,15 @@ static nlohmann::ordered_json time_axis_to_json(const TimeAxisReport &t)
     if (t.dt_available)
     {
         j["dt_ms"] = stats_to_json(t.dt_ms);
+        j["dt_median_ms"] = t.dt_median_ms;
+        j["dt_mode_ms"] = t.dt_mode_ms;
         j["sampling_hz_est"] = t.sampling_hz_est;
     }
     else
     {
         j["dt_ms"] = nullptr;
+        j["dt_median_ms"] = nullptr;
+        j["dt_mode_ms"] = nullptr;
         j["sampling_hz_est"] = nullptr;
     }
 
@@ -74,6 +125,39 @@ static nlohmann::ordered_json time_axis_to_json(const TimeAxisReport &t)
         {"gaps", t.anomalies.gaps},
     };
 
+    j["events"] = nlohmann::ordered_json::array();
+    for (const auto &e : t.events)
+        j["events"].push_back(event_to_json(e));
+
+    j["events_dropped"] = t.events_dropped;
+
+    return j;
+}
+
+static nlohmann::ordered_json reorder_to_json(const ReorderStats &r)
+{
+    return nlohmann::ordered_json{
+        {"window", r.window},
+        {"reordered", r.reordered},
+        {"duplicates_dropped", r.duplicates_dropped},
+        {"late_dropped", r.late_dropped},
+    };
+}
+
+static nlohmann::ordered_json psd_to_json(const PsdReport &p)
+{
+    nlohmann::ordered_json j{
+        {"window", p.window},
+        {"overlap", 0.5},
+        {"segments", p.segments},
+        {"fs_hz", p.fs_hz},
+        {"freq_hz", p.freq_hz},
+    };
+
+    const char *axes[3] = {"ax", "ay", "az"};
+    for (int a = 0; a < 3; ++a)
+        j[axes[a]] = p.psd[a];
+
     return j;
 }
 
@@ -106,19 +190,240 @@ nlohmann::ordered_json report_to_json(const Report &r)
         j["warnings"].push_back(warning_to_json(w));
 
     j["warnings_dropped"] = r.warnings_dropped;
+
+    j["warning_categories"] = nlohmann::ordered_json::array();
+    for (const auto &c : r.warning_categories)
+        j["warning_categories"].push_back(warning_category_to_json(c));
         
     j["time_axis"] = time_axis_to_json(r.time_axis);
 
     j["statistics"] = statistics_to_json(r.statistics);
 
+    if (r.reorder)
+        j["reorder"] = reorder_to_json(*r.reorder);
+
+    if (r.psd)
+        j["psd"] = psd_to_json(*r.psd);
+
     return j;
 }
 
 
+// ------------------------ streaming: same keys, same order, no tree ------------------------
+
+static void write_stats(JsonWriter &w, const Stats &s)
+{
+    w.begin_object();
+    w.field("count", s.count);
+    w.field("min", s.min);
+    w.field("max", s.max);
+    w.field("mean", s.mean);
+    w.field("std", s.std);
+    w.end_object();
+}
+
+static void write_warning(JsonWriter &w, const Warning &x)
+{
+    w.begin_object();
+    w.field("line", x.line);
+    w.field("message", x.message);
+
+    if (x.column.has_value())
+        w.field("column", *x.column);
+
+    if (x.value)
+        w.field("value", *x.value);
+
+    w.end_object();
+}
+
+static void write_warning_category(JsonWriter &w, const WarningCategory &c)
+{
+    const bool columns = c.kind == WarningKind::ColumnCount;
+
+    w.begin_object();
+    w.field("message", c.message());
+    w.field("kind", columns ? "column_count" : "invalid_value");
+    w.field(columns ? "columns" : "column", c.detail);
+    w.field("count", c.count);
+    w.field("first_line", c.first_line);
+    w.field("last_line", c.last_line);
+
+    w.key("samples");
+    w.begin_array();
+    for (std::size_t i = 0; i < c.sample_count; ++i)
+    {
+        const auto &s = c.samples[i];
+        w.begin_object();
+        w.field("line", s.line);
+        w.field("text", s.text());
+        if (s.truncated)
+            w.field("truncated", true);
+        w.end_object();
+    }
+    w.end_array();
+
+    w.end_object();
+}
+
+static void write_counts(JsonWriter &w, const Counts &c)
+{
+    w.begin_object();
+    w.field("total_lines", c.total_lines);
+    w.field("empty_lines", c.empty_lines);
+    w.field("comment_lines", c.comment_lines);
+    w.field("header_lines", c.header_lines);
+    w.field("parsed_lines", c.parsed_lines);
+    w.field("bad_lines", c.bad_lines);
+    w.field("outliers", c.outliers);
+    w.field("outlier_rows_dropped", c.outlier_rows_dropped);
+    w.field("outlier_values_replaced", c.outlier_values_replaced);
+    w.end_object();
+}
+
+static void write_event(JsonWriter &w, const TimeAxisEvent &e)
+{
+    w.begin_object();
+    w.field("kind", to_string(e.kind));
+    w.field("row", e.row);
+    w.field("line", e.line);
+    w.field("byte_offset", e.byte_offset);
+    w.field("t_before", e.t_before);
+    w.field("t_after", e.t_after);
+    w.field("dt", e.dt);
+    w.field("count", e.count);
+    w.end_object();
+}
+
+static void write_time_axis(JsonWriter &w, const TimeAxisReport &t)
+{
+    w.begin_object();
+    w.field("dt_available", t.dt_available);
+
+    if (t.dt_available)
+    {
+        w.key("dt_ms");
+        write_stats(w, t.dt_ms);
+        w.field("dt_median_ms", t.dt_median_ms);
+        w.field("dt_mode_ms", t.dt_mode_ms);
+        w.field("sampling_hz_est", t.sampling_hz_est);
+    }
+    else
+    {
+        w.field("dt_ms", nullptr);
+        w.field("dt_median_ms", nullptr);
+        w.field("dt_mode_ms", nullptr);
+        w.field("sampling_hz_est", nullptr);
+    }
+
+    w.key("anomalies");
+    w.begin_object();
+    w.field("non_increasing", t.anomalies.non_increasing);
+    w.field("duplicates", t.anomalies.duplicates);
+    w.field("gaps", t.anomalies.gaps);
+    w.end_object();
+
+    w.key("events");
+    w.begin_array();
+    for (const auto &e : t.events)
+        write_event(w, e);
+    w.end_array();
+
+    w.field("events_dropped", t.events_dropped);
+    w.end_object();
+}
+
+static void write_reorder(JsonWriter &w, const ReorderStats &r)
+{
+    w.begin_object();
+    w.field("window", r.window);
+    w.field("reordered", r.reordered);
+    w.field("duplicates_dropped", r.duplicates_dropped);
+    w.field("late_dropped", r.late_dropped);
+    w.end_object();
+}
+
+static void write_psd(JsonWriter &w, const PsdReport &p)
+{
+    w.begin_object();
+    w.field("window", p.window);
+    w.field("overlap", 0.5);
+    w.field("segments", p.segments);
+    w.field("fs_hz", p.fs_hz);
+    w.field("freq_hz", p.freq_hz);
+
+    const char *axes[3] = {"ax", "ay", "az"};
+    for (int a = 0; a < 3; ++a)
+        w.field(axes[a], p.psd[a]);
+
+    w.end_object();
+}
+
+void write_report_json(JsonWriter &w, const Report &r)
+{
+    w.begin_object();
+    w.field("input", r.input);
+
+    w.key("counts");
+    write_counts(w, r.counts);
+
+    w.key("warnings");
+    w.begin_array();
+    for (const auto &x : r.warnings)
+        write_warning(w, x);
+    w.end_array();
+
+    w.field("warnings_dropped", r.warnings_dropped);
+
+    w.key("warning_categories");
+    w.begin_array();
+    for (const auto &c : r.warning_categories)
+        write_warning_category(w, c);
+    w.end_array();
+
+    w.key("time_axis");
+    write_time_axis(w, r.time_axis);
+
+    w.key("statistics");
+    w.begin_object();
+    w.key("ax");
+    write_stats(w, r.statistics.ax);
+    w.key("ay");
+    write_stats(w, r.statistics.ay);
+    w.key("az");
+    write_stats(w, r.statistics.az);
+    w.end_object();
+
+    if (r.reorder)
+    {
+        w.key("reorder");
+        write_reorder(w, *r.reorder);
+    }
+
+    if (r.psd)
+    {
+        w.key("psd");
+        write_psd(w, *r.psd);
+    }
+
+    w.end_object();
+}
+
+std::string report_json_text(const Report &r)
+{
+    std::string out;
+    out.reserve(4096 + 256 * r.warnings.size() + 320 * r.time_axis.events.size());
+
+    JsonWriter w(out);
+    write_report_json(w, r);
+    return out;
+}
+
+
 std::filesystem::path default_report_json_path(const std::filesystem::path &input_path)
 {
-    // Copy the input path and replace the extension with .json
-    std::filesystem::path out = input_path;
+    // Copy the input path (without .gz/.zst) and replace the extension with .json
+    std::filesystem::path out = strip_compression_extension(input_path);
     out.replace_extension(".json");
     return out;
 }
@@ -126,15 +431,24 @@ std::filesystem::path default_report_json_path(const std::filesystem::path &inpu
 
 void write_report_json_file(const Report &r, const std::filesystem::path &output_path)
 {
+    if (is_stdio_path(output_path))
+    {
+        std::cout << report_json_text(r) << '\n';
+        std::cout.flush();
+
+        if (!std::cout)
+            throw std::runtime_error("Failed to write report to stdout");
+        return;
+    }
+
     // Open file for writing
     std::ofstream f(output_path);
 
     if (!f)
         throw std::runtime_error("Failed to open file for writing: " + output_path.string());
 
-    // Convert the report to JSON and write it with indentation
-    nlohmann::ordered_json j = report_to_json(r);
-    f << j.dump(4);
+    // Streamed straight into one buffer, written at once
+    f << report_json_text(r);
 }
 
 } 
\ No newline at end of file
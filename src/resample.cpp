@@ -0,0 +1,143 @@
+#include "sla/resample.hpp"
+#include "sla/writer.hpp"
+#include "sla/csv.hpp"
+
+#include <cmath>
+#include <utility>
+
+
+namespace sla
+{
+
+    bool parse_resample_kernel(std::string_view s, ResampleKernel &out)
+    {
+        if (s == "linear")  { out = ResampleKernel::Linear;  return true; }
+        if (s == "nearest") { out = ResampleKernel::Nearest; return true; }
+        return false;
+    }
+
+    bool parse_gap_policy(std::string_view s, GapPolicy &out)
+    {
+        if (s == "fill")  { out = GapPolicy::Fill;  return true; }
+        if (s == "split") { out = GapPolicy::Split; return true; }
+        return false;
+    }
+
+    Resampler::Resampler(const ResampleOptions &opt, ResampleResult &res, Emit emit)
+        : opt_(opt), res_(res), emit_(std::move(emit)), period_ms_(1000.0 / opt.rate_hz)
+    {
+    }
+
+    void Resampler::push(const Row &row)
+    {
+        if (!have_prev_)
+        {
+            prev_ = row;
+            have_prev_ = true;
+
+            // first grid point at or after the first sample
+            k_ = static_cast<std::int64_t>(std::ceil(row[0] / period_ms_));
+            if (static_cast<double>(k_) * period_ms_ == row[0])
+            {
+                emit_(row);
+                k_++;
+            }
+            return;
+        }
+
+        if (!(row[0] > prev_[0]))
+        {
+            res_.rows_skipped++;
+            return;
+        }
+
+        const bool gap = opt_.max_gap_ms > 0.0 && row[0] - prev_[0] > opt_.max_gap_ms;
+        if (gap)
+            res_.gaps++;
+
+        // grid time from the index, not by accumulation: no drift over long files
+        for (double g = static_cast<double>(k_) * period_ms_; g <= row[0];
+             g = static_cast<double>(++k_) * period_ms_)
+        {
+            if (gap && opt_.gap_policy == GapPolicy::Split && g < row[0])
+            {
+                res_.grid_points_skipped++;
+                continue;
+            }
+            emit_(interpolate(g, prev_, row));
+        }
+
+        prev_ = row;
+    }
+
+    Resampler::Row Resampler::interpolate(double t, const Row &a, const Row &b) const
+    {
+        Row out{t, 0.0, 0.0, 0.0};
+
+        if (opt_.kernel == ResampleKernel::Nearest)
+        {
+            const Row &src = (t - a[0] <= b[0] - t) ? a : b;
+            out[1] = src[1];
+            out[2] = src[2];
+            out[3] = src[3];
+            return out;
+        }
+
+        const double w = (t - a[0]) / (b[0] - a[0]);
+        for (int c = 1; c < 4; ++c)
+            out[c] = a[c] + (b[c] - a[c]) * w;
+        return out;
+    }
+
+    ResampleResult run_resample(const ResampleOptions &opt)
+    {
+        ResampleResult res;
+
+        if (!(opt.rate_hz > 0.0) || !std::isfinite(opt.rate_hz))
+        {
+            res.ok = false;
+            res.error = "rate must be > 0";
+            return res;
+        }
+
+        CsvWriter writer;
+        if (!writer.open(opt.output_path))
+        {
+            res.ok = false;
+            res.error = "can't open file for writing: " + opt.output_path.string();
+            return res;
+        }
+        writer.write_header(EXPECTED_HEADER);
+
+        Resampler rs(opt, res, [&](const std::array<double, 4> &row)
+        {
+            writer.write_row(row);
+            res.rows_out++;
+        });
+
+        auto in = read_imu_csv_streaming(opt.input_path,
+        [&](const std::array<double, 4> &row)
+        {
+            rs.push(row);
+        });
+
+        writer.close();
+
+        res.input_name = in.input_name;
+        res.counts = in.counts;
+
+        if (!in.ok)
+        {
+            res.ok = false;
+            res.error = in.error;
+        }
+        else if (!writer.ok())
+        {
+            res.ok = false;
+            res.error = "write failed: " + opt.output_path.string();
+        }
+
+        return res;
+    }
+
+}
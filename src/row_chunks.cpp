@@ -0,0 +1,154 @@
+#include "sla/row_chunks.hpp"
+#include "sla/csv.hpp"
+#include "sla/input_source.hpp"
+
+#include <algorithm>
+#include <map>
+
+namespace sla
+{
+    RowChunkSums::RowChunkSums(std::size_t max_chunks)
+        : chunks_(max_chunks)
+    {
+    }
+
+    void RowChunkSums::add(const std::array<double, 4> &row, std::uint64_t byte_offset)
+    {
+        chunks_.add([&](RowChunk &c, bool first)
+                    {
+                        if (first)
+                            c.byte_offset = byte_offset;
+                        c.sum.x += row[1];
+                        c.sum.y += row[2];
+                        c.sum.z += row[3];
+                    });
+    }
+
+    void RowChunkSums::finish()
+    {
+        chunks_.finish();
+    }
+
+    namespace
+    {
+        // rows [begin, end) of one chunk that go to target
+        struct EdgePart
+        {
+            std::uint64_t begin{};
+            std::uint64_t end{};
+            std::size_t target{};
+        };
+
+        // Rows of one partial chunk handed to their targets
+        struct EdgeChunk
+        {
+            std::vector<EdgePart> parts;
+            std::uint64_t first_row{};
+            std::uint64_t rows{};
+
+            void add(std::uint64_t row, const std::array<double, 4> &v,
+                     std::vector<Vec3> &sum, std::vector<std::uint64_t> &n) const
+            {
+                for (const auto &p : parts)
+                {
+                    if (p.begin <= row && row < p.end)
+                    {
+                        sum[p.target].x += v[1];
+                        sum[p.target].y += v[2];
+                        sum[p.target].z += v[3];
+                        n[p.target]++;
+                    }
+                }
+            }
+        };
+    }
+
+    bool sum_row_ranges(const std::filesystem::path &input, const RowChunkSums &chunks,
+                        const std::vector<RowRange> &ranges, std::size_t targets,
+                        std::vector<Vec3> &sum, std::vector<std::uint64_t> &n, std::string &error)
+    {
+        sum.assign(targets, Vec3{});
+        n.assign(targets, 0);
+
+        const std::uint64_t R = chunks.chunk_rows();
+        const std::uint64_t N = chunks.rows();
+        auto chunk_end = [&](std::uint64_t c) { return std::min((c + 1) * R, N); };
+
+        std::map<std::uint64_t, EdgeChunk> edges;
+
+        for (const auto &r : ranges)
+        {
+            const std::uint64_t end = std::min(r.end, N);
+            if (r.begin >= end)
+                continue;
+
+            for (std::uint64_t c = r.begin / R; c * R < end; ++c)
+            {
+                if (r.begin <= c * R && chunk_end(c) <= end)
+                {
+                    const Vec3 &s = chunks.sum(static_cast<std::size_t>(c));
+                    sum[r.target].x += s.x;
+                    sum[r.target].y += s.y;
+                    sum[r.target].z += s.z;
+                    n[r.target] += chunk_end(c) - c * R;
+                    continue;
+                }
+
+                auto &e = edges[c];
+                e.first_row = c * R;
+                e.rows = chunk_end(c) - c * R;
+                e.parts.push_back({std::max(r.begin, c * R), std::min(end, chunk_end(c)), r.target});
+            }
+        }
+
+        if (edges.empty())
+            return true;
+
+        // seek to every edge chunk; compressed inputs fall back to one read
+        std::string seek_error;
+        if (open_input_at(input, 0, seek_error))
+        {
+            for (const auto &[c, e] : edges)
+            {
+                std::uint64_t row = e.first_row;
+                auto part = read_imu_csv_streaming_at(input, chunks.byte_offset(static_cast<std::size_t>(c)), e.rows,
+                [&](const std::array<double, 4> &v)
+                {
+                    e.add(row++, v, sum, n);
+                });
+
+                if (!part.ok)
+                {
+                    error = part.error;
+                    return false;
+                }
+                if (row != e.first_row + e.rows)
+                {
+                    error = "input changed while reading: " + input.string();
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        auto next = edges.begin();
+        std::uint64_t row = 0;
+        auto all = read_imu_csv_streaming(input,
+        [&](const std::array<double, 4> &v)
+        {
+            const std::uint64_t r = row++;
+            while (next != edges.end() && next->second.first_row + next->second.rows <= r)
+                ++next;
+            if (next != edges.end() && next->second.first_row <= r)
+                next->second.add(r, v, sum, n);
+        });
+
+        if (!all.ok)
+        {
+            error = all.error;
+            return false;
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,283 @@
+#include "sla/steady.hpp"
+
+#include <cmath>
+
+namespace sla
+{
+    SteadySegmenter::SteadySegmenter(const SteadyOptions &opt)
+        : window_(opt.window < 2 ? 2 : opt.window),
+          var_limit_(opt.threshold * opt.threshold),
+          min_rows_(opt.min_rows ? opt.min_rows : 2 * static_cast<std::uint64_t>(window_)),
+          ring_(window_)
+    {
+    }
+
+    void SteadySegmenter::push(double ax, double ay, double az)
+    {
+        const std::uint64_t row = rows_++;
+        if (row == 0)
+            ref_ = {ax, ay, az};
+
+        const std::array<double, 3> d{ax - ref_[0], ay - ref_[1], az - ref_[2]};
+        auto &slot = ring_[row % window_];
+
+        for (int k = 0; k < 3; ++k)
+        {
+            if (row >= window_)
+            {
+                sum_[k] -= slot[k];
+                sum_sq_[k] -= slot[k] * slot[k];
+            }
+            sum_[k] += d[k];
+            sum_sq_[k] += d[k] * d[k];
+        }
+        slot = d;
+
+        if (row + 1 < window_)
+            return;
+
+        const double n = static_cast<double>(window_);
+        double var = 0.0;
+        for (int k = 0; k < 3; ++k)
+            var += (sum_sq_[k] - sum_[k] * sum_[k] / n) / n;
+
+        const std::uint64_t first = row + 1 - window_;
+
+        if (var > var_limit_)
+        {
+            if (open_)
+                close(row);
+            return;
+        }
+
+        if (open_)
+        {
+            for (int k = 0; k < 3; ++k)
+                seg_sum_[k] += d[k];
+        }
+        else if (first >= last_end_)
+        {
+            // the whole window joins the new segment
+            open_ = true;
+            begin_ = first;
+            seg_sum_ = sum_;
+        }
+    }
+
+    void SteadySegmenter::finish()
+    {
+        if (open_)
+            close(rows_);
+    }
+
+    void SteadySegmenter::close(std::uint64_t end)
+    {
+        open_ = false;
+        last_end_ = end;
+
+        if (end - begin_ < min_rows_)
+            return;
+
+        SteadySegment s;
+        s.begin = begin_;
+        s.end = end;
+        const double n = static_cast<double>(end - begin_);
+        for (int k = 0; k < 3; ++k)
+            s.mean[k] = ref_[k] + seg_sum_[k] / n;
+        segments_.push_back(s);
+    }
+
+    static bool within_angle(const std::array<double, 3> &a, const std::array<double, 3> &b, double cos_limit)
+    {
+        const double dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        const double na = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+        const double nb = std::sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+        return na > 0.0 && nb > 0.0 && dot >= cos_limit * na * nb;
+    }
+
+    std::vector<int> match_steady_segments(
+        const std::vector<SteadySegment> &segments,
+        const std::vector<std::array<double, 3>> &expected,
+        double max_angle_deg)
+    {
+        const std::size_t S = segments.size();
+        const std::size_t P = expected.size();
+        if (P == 0 || S < P)
+            return {};
+
+        const double cos_limit = std::cos(max_angle_deg * 3.14159265358979323846 / 180.0);
+
+        // best[s][p]: rows covered using segments [0, s) with positions [0, p)
+        // matched, the last used segment going to p - 1; -1 = impossible
+        enum : std::uint8_t { Skip, Extend, Next };
+        const std::size_t W = P + 1;
+        std::vector<std::int64_t> best((S + 1) * W, -1);
+        std::vector<std::uint8_t> how((S + 1) * W, Skip);
+        best[0] = 0;
+
+        for (std::size_t s = 0; s < S; ++s)
+        {
+            const auto len = static_cast<std::int64_t>(segments[s].end - segments[s].begin);
+
+            for (std::size_t p = 0; p <= P; ++p)
+            {
+                std::int64_t v = best[s * W + p];
+                std::uint8_t h = Skip;
+
+                if (p > 0 && within_angle(segments[s].mean, expected[p - 1], cos_limit))
+                {
+                    if (best[s * W + p] >= 0 && best[s * W + p] + len > v)
+                    {
+                        v = best[s * W + p] + len;
+                        h = Extend;
+                    }
+                    if (best[s * W + p - 1] >= 0 && best[s * W + p - 1] + len > v)
+                    {
+                        v = best[s * W + p - 1] + len;
+                        h = Next;
+                    }
+                }
+
+                best[(s + 1) * W + p] = v;
+                how[(s + 1) * W + p] = h;
+            }
+        }
+
+        if (best[S * W + P] < 0)
+            return {};
+
+        std::vector<int> out(S, -1);
+        std::size_t p = P;
+        for (std::size_t s = S; s > 0; --s)
+        {
+            const std::uint8_t h = how[s * W + p];
+            if (h == Skip)
+                continue;
+
+            out[s - 1] = static_cast<int>(p - 1);
+            if (h == Next)
+                --p;
+        }
+        return out;
+    }
+
+    static std::array<double, 3> unit(const std::array<double, 3> &a)
+    {
+        const double n = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+        if (!(n > 0.0))
+            return {0.0, 0.0, 0.0};
+        return {a[0] / n, a[1] / n, a[2] / n};
+    }
+
+    static double dot3(const std::array<double, 3> &a, const std::array<double, 3> &b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    std::vector<int> cluster_steady_segments(
+        const std::vector<SteadySegment> &segments,
+        const std::vector<std::array<double, 3>> &expected,
+        double max_angle_deg)
+    {
+        const std::size_t S = segments.size();
+        const std::size_t P = expected.size();
+        if (P == 0 || S < P)
+            return {};
+
+        const double cos_limit = std::cos(max_angle_deg * 3.14159265358979323846 / 180.0);
+        constexpr double SAME_DIRECTION = 1.0 - 1e-9;
+
+        // one cluster per distinct expected direction, with its positions
+        std::vector<std::array<double, 3>> seed;
+        std::vector<std::vector<int>> members;
+        for (std::size_t p = 0; p < P; ++p)
+        {
+            const auto u = unit(expected[p]);
+            if (dot3(u, u) == 0.0)
+                return {};
+
+            std::size_t c = 0;
+            for (; c < seed.size(); ++c)
+            {
+                const double d = dot3(u, seed[c]);
+                if (d >= SAME_DIRECTION)
+                    break;
+                if (d >= cos_limit)
+                    return {};
+            }
+            if (c == seed.size())
+            {
+                seed.push_back(u);
+                members.emplace_back();
+            }
+            members[c].push_back(static_cast<int>(p));
+        }
+
+        const std::size_t K = seed.size();
+        std::vector<std::array<double, 3>> centroid = seed;
+
+        std::vector<std::array<double, 3>> dir(S);
+        for (std::size_t s = 0; s < S; ++s)
+            dir[s] = unit(segments[s].mean);
+
+        // converges in a few rounds: the seeds are already close
+        constexpr int MAX_ITERATIONS = 100;
+        std::vector<std::size_t> assign(S, K);
+
+        for (int iter = 0; iter < MAX_ITERATIONS; ++iter)
+        {
+            bool changed = false;
+            for (std::size_t s = 0; s < S; ++s)
+            {
+                std::size_t best = 0;
+                for (std::size_t c = 1; c < K; ++c)
+                {
+                    if (dot3(dir[s], centroid[c]) > dot3(dir[s], centroid[best]))
+                        best = c;
+                }
+                changed |= assign[s] != best;
+                assign[s] = best;
+            }
+            if (!changed)
+                break;
+
+            std::vector<std::array<double, 3>> acc(K, {0.0, 0.0, 0.0});
+            for (std::size_t s = 0; s < S; ++s)
+            {
+                const double w = static_cast<double>(segments[s].end - segments[s].begin);
+                for (int k = 0; k < 3; ++k)
+                    acc[assign[s]][k] += w * dir[s][k];
+            }
+
+            // an empty cluster keeps its direction
+            for (std::size_t c = 0; c < K; ++c)
+            {
+                const auto u = unit(acc[c]);
+                if (dot3(u, u) > 0.0)
+                    centroid[c] = u;
+            }
+        }
+
+        std::vector<std::vector<std::size_t>> accepted(K);
+        for (std::size_t s = 0; s < S; ++s)
+        {
+            if (within_angle(segments[s].mean, seed[assign[s]], cos_limit))
+                accepted[assign[s]].push_back(s);
+        }
+
+        std::vector<int> out(S, -1);
+        for (std::size_t c = 0; c < K; ++c)
+        {
+            const std::size_t n = accepted[c].size();
+            const std::size_t k = members[c].size();
+            if (n < k)
+                return {};
+
+            // consecutive runs, at least one segment per position
+            for (std::size_t j = 0; j < n; ++j)
+                out[accepted[c][j]] = members[c][j * k / n];
+        }
+        return out;
+    }
+
+}
@@ -0,0 +1,312 @@
+#include "sla/synth.hpp"
+#include "sla/writer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <future>
+#include <string>
+#include <thread>
+
+
+namespace sla
+{
+
+    namespace
+    {
+        // Values are quantized like an ADC would; this also lets the writer use
+        // a fixed-point formatter that round-trips exactly
+        constexpr int TIME_DECIMALS = 3;
+        constexpr int ACCEL_DECIMALS = 9;
+
+        constexpr double pow10(int n) { return n == 0 ? 1.0 : 10.0 * pow10(n - 1); }
+
+        double quantize(double v, int decimals)
+        {
+            return std::round(v * pow10(decimals)) / pow10(decimals);
+        }
+    }
+
+    SynthImuSource::SynthImuSource(const SynthOptions &opt)
+        : opt_(opt),
+          rng_(opt.seed),
+          period_ms_(opt.rate_hz > 0.0 ? 1000.0 / opt.rate_hz : 0.0)
+    {
+        for (const auto &p : opt_.positions)
+            block_g_.push_back(gravity_true(opt_.gravity, p.inner, p.outer));
+
+        if (block_g_.empty())
+            block_g_.push_back(gravity_true(opt_.gravity, 0.0, 0.0));
+    }
+
+    Vec3 SynthImuSource::true_gravity(std::uint64_t i, bool &rotating) const
+    {
+        rotating = false;
+        if (opt_.positions.empty())
+            return block_g_[0];
+
+        // equal blocks like run_calibration; the remainder goes to the last block
+        const std::uint64_t npos = block_g_.size();
+        const std::uint64_t L = std::max<std::uint64_t>(1, opt_.rows / npos);
+        const std::uint64_t block = std::min(i / L, npos - 1);
+        const std::uint64_t offset = i - block * L;
+        const std::uint64_t len = (block == npos - 1) ? (opt_.rows - block * L) : L;
+
+        const double frac = static_cast<double>(offset) / static_cast<double>(len);
+        if (block == 0 || frac >= opt_.transition_frac)
+            return block_g_[block];
+
+        // turntable is still rotating from the previous position
+        rotating = true;
+        const double s = frac / opt_.transition_frac;
+        const Position &a = opt_.positions[block - 1];
+        const Position &b = opt_.positions[block];
+        const double inner = a.inner + s * (b.inner - a.inner);
+        const double outer = a.outer + s * (b.outer - a.outer);
+        return gravity_true(opt_.gravity, inner, outer);
+    }
+
+    bool SynthImuSource::next(std::array<double, 4> &row)
+    {
+        if (i_ >= opt_.rows)
+            return false;
+
+        // Every row draws the same number of values, so enabling one defect
+        // doesn't reshuffle the others
+        const double u_gap = rng_.uniform();
+        const double u_order = rng_.uniform();
+        const double jitter = rng_.symmetric(opt_.jitter_ms);
+        const double nx = rng_.symmetric(1.0);
+        const double ny = rng_.symmetric(1.0);
+        const double nz = rng_.symmetric(1.0);
+
+        if (i_ > 0 && u_gap < opt_.gap_ratio)
+            gap_offset_ms_ += opt_.gap_ms;
+
+        double t = static_cast<double>(i_) * period_ms_ + gap_offset_ms_ + jitter;
+
+        if (i_ > 0)
+        {
+            if (u_order < opt_.duplicate_ratio)
+                t = last_t_;
+            else if (u_order < opt_.duplicate_ratio + opt_.out_of_order_ratio)
+                t = last_t_ - 0.5 * period_ms_;
+        }
+
+        t = quantize(t, TIME_DECIMALS);
+        last_t_ = t;
+
+        bool rotating = false;
+        const Vec3 g = true_gravity(i_, rotating);
+        const Mat3 &M = opt_.M;
+        const double amp = rotating ? 5.0 * opt_.noise : opt_.noise;
+
+        row[0] = t;
+        row[1] = quantize(M.a[0][0] * g.x + M.a[0][1] * g.y + M.a[0][2] * g.z + opt_.b.x + amp * nx, ACCEL_DECIMALS);
+        row[2] = quantize(M.a[1][0] * g.x + M.a[1][1] * g.y + M.a[1][2] * g.z + opt_.b.y + amp * ny, ACCEL_DECIMALS);
+        row[3] = quantize(M.a[2][0] * g.x + M.a[2][1] * g.y + M.a[2][2] * g.z + opt_.b.z + amp * nz, ACCEL_DECIMALS);
+
+        i_++;
+        return true;
+    }
+
+    namespace
+    {
+        constexpr std::size_t CHUNK_ROWS = 1 << 16;
+
+        struct Chunk
+        {
+            std::vector<std::array<double, 4>> rows;
+            std::vector<std::uint8_t> bad; // 0 = none, else 1 + kind of the malformed line before the row
+        };
+
+        // Fixed-point text of an already quantized value, trailing zeros trimmed:
+        // 10.000 -> "10", 9.607532500 -> "9.6075325". Several times faster than
+        // shortest to_chars and parses back to the same double
+        void append_fixed(std::string &out, double v, int decimals)
+        {
+            const double scale = pow10(decimals);
+            long long k = std::llround(v * scale);
+
+            char buf[40];
+            char *end = buf + sizeof(buf);
+            char *p = end;
+
+            const bool neg = k < 0;
+            unsigned long long u = neg ? 0ull - static_cast<unsigned long long>(k)
+                                       : static_cast<unsigned long long>(k);
+
+            // fraction, skipping trailing zeros
+            bool any_frac = false;
+            for (int i = 0; i < decimals; ++i)
+            {
+                const char d = static_cast<char>('0' + u % 10);
+                u /= 10;
+                if (any_frac || d != '0')
+                {
+                    *--p = d;
+                    any_frac = true;
+                }
+            }
+            if (any_frac)
+                *--p = '.';
+
+            do
+            {
+                *--p = static_cast<char>('0' + u % 10);
+                u /= 10;
+            } while (u != 0);
+
+            if (neg)
+                *--p = '-';
+
+            out.append(p, end);
+        }
+
+        void append_double(std::string &out, double v)
+        {
+            append_fixed(out, v, ACCEL_DECIMALS);
+        }
+
+        void append_row(std::string &out, const std::array<double, 4> &r)
+        {
+            append_fixed(out, r[0], TIME_DECIMALS);
+            out += ',';
+            append_double(out, r[1]);
+            out += ',';
+            append_double(out, r[2]);
+            out += ',';
+            append_double(out, r[3]);
+            out += '\n';
+        }
+
+        // One of the defects seen in data/imu_dirty.csv
+        void append_malformed(std::string &out, int kind, const std::array<double, 4> &r)
+        {
+            switch (kind)
+            {
+            case 0: // too few columns
+                append_fixed(out, r[0], TIME_DECIMALS);
+                out += ',';
+                append_double(out, r[1]);
+                out += ',';
+                append_double(out, r[2]);
+                out += '\n';
+                break;
+            case 1: // too many columns
+                out.append(std::string_view("0,"));
+                append_row(out, r);
+                break;
+            case 2: // garbage token
+                append_fixed(out, r[0], TIME_DECIMALS);
+                out.append(std::string_view(",\"N;\",0,0\n"));
+                break;
+            case 3: // truncated exponent
+                append_fixed(out, r[0], TIME_DECIMALS);
+                out.append(std::string_view(",0,-9.8e-,0\n"));
+                break;
+            default: // empty fields
+                out.append(std::string_view(",,,\n"));
+                break;
+            }
+        }
+
+        std::string format_chunk(const Chunk &c)
+        {
+            std::string out;
+            out.reserve(c.rows.size() * 80);
+
+            for (std::size_t i = 0; i < c.rows.size(); ++i)
+            {
+                if (c.bad[i] != 0)
+                    append_malformed(out, c.bad[i] - 1, c.rows[i]);
+                append_row(out, c.rows[i]);
+            }
+            return out;
+        }
+    }
+
+    SynthResult write_synthetic_csv(const SynthOptions &opt, const std::filesystem::path &out_path)
+    {
+        SynthResult res;
+
+        if (!(opt.rate_hz > 0.0))
+        {
+            res.ok = false;
+            res.error = "rate must be > 0";
+            return res;
+        }
+
+        BufferedWriter out;
+        if (!out.open(out_path))
+        {
+            res.ok = false;
+            res.error = "can't open file for writing: " + out_path.string();
+            return res;
+        }
+
+        out.write("t_ms,ax,ay,az\n");
+
+        // Rows are generated sequentially (the RNG stream defines the file),
+        // text formatting - the expensive part - runs on worker threads.
+        // Chunks are written in order, so the output doesn't depend on the thread count
+        SynthImuSource src(opt);
+        SplitMix64 bad_rng(opt.seed ^ 0xD1B54A32D192ED03ull);
+
+        const std::size_t max_inflight = std::max(2u, std::thread::hardware_concurrency());
+        std::deque<std::future<std::string>> inflight;
+
+        auto write_front = [&]()
+        {
+            out.write(inflight.front().get());
+            inflight.pop_front();
+        };
+
+        std::array<double, 4> row{};
+        bool more = true;
+        while (more)
+        {
+            Chunk c;
+            c.rows.reserve(CHUNK_ROWS);
+            c.bad.reserve(CHUNK_ROWS);
+
+            while (c.rows.size() < CHUNK_ROWS && (more = src.next(row)))
+            {
+                std::uint8_t bad = 0;
+                if (opt.malformed_ratio > 0.0 && bad_rng.uniform() < opt.malformed_ratio)
+                {
+                    bad = static_cast<std::uint8_t>(1 + bad_rng.next() % 5);
+                    res.malformed_lines++;
+                }
+                c.rows.push_back(row);
+                c.bad.push_back(bad);
+            }
+
+            if (c.rows.empty())
+                break;
+
+            inflight.push_back(std::async(std::launch::async,
+                [c = std::move(c)]() { return format_chunk(c); }));
+
+            if (inflight.size() >= max_inflight)
+                write_front();
+        }
+
+        while (!inflight.empty())
+            write_front();
+
+        out.close();
+
+        res.rows = src.produced();
+        res.bytes = out.bytes_written();
+
+        if (!out.ok())
+        {
+            res.ok = false;
+            res.error = "write error: " + out_path.string();
+        }
+
+        return res;
+    }
+
+}
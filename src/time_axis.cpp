@@ -1,71 +1,223 @@
 #include "sla/time_axis.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 namespace sla
 {
-    TimeAxisReport make_time_axis_report_streaming(const TimestampStream &stream)
+    static constexpr double EPS = 1e-9;
+
+    std::size_t DtHistogram::bucket_index(double dt)
     {
-        TimeAxisReport rep{};
+        int e = 0;
+        const double m = std::frexp(dt, &e);   // dt = m * 2^e, m in [0.5, 1)
+        const int octave = e - 1;
+
+        if (!(dt > 0.0) || octave < MIN_EXP)
+            return 0;
+        if (octave >= MAX_EXP)
+            return BUCKETS - 1;
+
+        const auto sub = static_cast<std::size_t>((2.0 * m - 1.0) * (1 << SUB_BITS));
+        return (static_cast<std::size_t>(octave - MIN_EXP) << SUB_BITS) + sub;
+    }
+
+    double DtHistogram::bucket_lower(std::size_t i)
+    {
+        const int octave = static_cast<int>(i >> SUB_BITS) + MIN_EXP;
+        const double sub = static_cast<double>(i & ((std::size_t{1} << SUB_BITS) - 1));
+        return std::ldexp(1.0 + sub / (1 << SUB_BITS), octave);
+    }
+
+    void DtHistogram::add(double dt)
+    {
+        const std::size_t i = bucket_index(dt);
+        if (counts_[i] == 0 || dt < mins_[i])
+            mins_[i] = dt;
+        if (counts_[i] == 0 || dt > maxs_[i])
+            maxs_[i] = dt;
+        counts_[i]++;
+        total_++;
+    }
 
-        // Pass 1: dt stats
-        sla::WelfordStats dt_stats;
-        bool have_last = false;
-        double last = 0.0;
+    double DtHistogram::quantile(double q) const
+    {
+        if (total_ == 0)
+            return 0.0;
+
+        q = q < 0.0 ? 0.0 : (q > 1.0 ? 1.0 : q);
+        const double rank = q * static_cast<double>(total_ - 1);
 
-        stream([&](double t)
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKETS; ++i)
         {
-            if (have_last)
+            if (counts_[i] == 0 || static_cast<double>(seen + counts_[i]) <= rank)
             {
-                const double dt = t - last;
-                if (dt > 0.0)
-                    dt_stats.update(dt);
+                seen += counts_[i];
+                continue;
             }
-            last = t;
-            have_last = true;
-        });
 
-        if (dt_stats.count() > 0)
+            // the bucket's values evenly spread over [min, max]: rank seen -> min, last -> max
+            if (counts_[i] == 1)
+                return mins_[i];
+            const double f = (rank - static_cast<double>(seen)) / static_cast<double>(counts_[i] - 1);
+            return mins_[i] + (maxs_[i] - mins_[i]) * std::min(f, 1.0);
+        }
+        return 0.0;
+    }
+
+    // count per ms of bucket i (the buckets widen with dt)
+    double DtHistogram::density(std::size_t i) const
+    {
+        if (i >= BUCKETS)
+            return 0.0;
+        const double hi = i + 1 < BUCKETS ? bucket_lower(i + 1) : std::ldexp(1.0, MAX_EXP);
+        return static_cast<double>(counts_[i]) / (hi - bucket_lower(i));
+    }
+
+    double DtHistogram::mode() const
+    {
+        if (total_ == 0)
+            return 0.0;
+
+        std::size_t best = 0;
+        for (std::size_t i = 1; i < BUCKETS; ++i)
         {
-            rep.dt_ms.count = static_cast<int>(dt_stats.count());
-            rep.dt_ms.min = dt_stats.min();
-            rep.dt_ms.max = dt_stats.max();
-            rep.dt_ms.mean = dt_stats.mean();
-            rep.dt_ms.std = dt_stats.stddev();
+            if (counts_[i] > counts_[best])
+                best = i;
         }
 
-        constexpr double EPS = 1e-9;
-        rep.dt_available = (rep.dt_ms.count > 0) && (rep.dt_ms.mean > EPS);
-        rep.sampling_hz_est = rep.dt_available ? (1000.0 / rep.dt_ms.mean) : 0.0;
+        if (mins_[best] == maxs_[best])
+            return mins_[best];
+
+        // the peak leans towards the denser neighbour
+        const double lo = bucket_lower(best);
+        const double hi = best + 1 < BUCKETS ? bucket_lower(best + 1) : std::ldexp(1.0, MAX_EXP);
+        const double d = density(best);
+        const double d_prev = best > 0 ? density(best - 1) : 0.0;
+        const double d_next = density(best + 1);
+        const double denom = (d - d_prev) + (d - d_next);
+        const double peak = denom > 0.0 ? lo + (hi - lo) * (d - d_prev) / denom : 0.5 * (lo + hi);
 
-        // Pass 2: anomalies with final expected_dt
-        TimeAxisIssues anomalies{};
-        const double expected_dt = rep.dt_available ? rep.dt_ms.mean : 0.0;
+        return std::clamp(peak, mins_[best], maxs_[best]);
+    }
 
-        bool have_last2 = false;
-        double last2 = 0.0;
+    std::string_view to_string(TimeAxisEventKind kind)
+    {
+        switch (kind)
+        {
+        case TimeAxisEventKind::NonIncreasing: return "non_increasing";
+        case TimeAxisEventKind::Duplicate:     return "duplicate";
+        case TimeAxisEventKind::Gap:           return "gap";
+        }
+        return "unknown";
+    }
 
-        stream([&](double t)
+    void TimeAxisAccumulator::update(double t, std::uint64_t line, std::uint64_t byte_offset)
+    {
+        if (have_last_)
         {
-            if (have_last2)
+            const double dt = t - last_;
+
+            if (dt < -EPS)
             {
-                const double dt = t - last2;
-                
-                if (dt < -EPS)
-                anomalies.non_increasing++;
-                else if (std::abs(dt) <= EPS)
-                    anomalies.duplicates++;
+                anomalies_.non_increasing++;
+                record(TimeAxisEventKind::NonIncreasing, t, dt, line, byte_offset);
+            }
+            else if (std::abs(dt) <= EPS)
+            {
+                anomalies_.duplicates++;
+                record(TimeAxisEventKind::Duplicate, t, dt, line, byte_offset);
+            }
+
+            // expected dt = median of what we have seen so far (the gap itself isn't in it yet)
+            if (median_dt_ > EPS && dt > EPS && dt > 2 * median_dt_)
+            {
+                anomalies_.gaps++;
+                record(TimeAxisEventKind::Gap, t, dt, line, byte_offset);
+            }
 
-                if (expected_dt > EPS && dt > EPS && dt > 2 * expected_dt)
-                    anomalies.gaps++;
+            if (dt > 0.0)
+            {
+                dt_stats_.update(dt);
+                dt_hist_.add(dt);
 
+                // a median walk touches ~1600 buckets: refresh often at first, then rarely
+                const std::uint64_t n = dt_hist_.count();
+                if ((n & (n - 1)) == 0 || n % 1024 == 0)
+                    median_dt_ = dt_hist_.median();
             }
-            last2 = t;
-            have_last2 = true;
-        });
+        }
+        last_ = t;
+        have_last_ = true;
+        row_++;
+    }
 
-        rep.anomalies = anomalies;
+    void TimeAxisAccumulator::record(TimeAxisEventKind kind, double t, double dt,
+                                     std::uint64_t line, std::uint64_t byte_offset)
+    {
+        // same anomaly on the very next row: extend the run
+        if (!events_.empty() && events_.back().kind == kind && last_event_row_ + 1 == row_)
+        {
+            auto &e = events_.back();
+            e.t_after = t;
+            e.dt = e.t_after - e.t_before;
+            e.count++;
+            last_event_row_ = row_;
+            return;
+        }
+
+        if (events_.size() >= max_events_)
+        {
+            events_dropped_++;
+            return;
+        }
+
+        TimeAxisEvent e;
+        e.kind = kind;
+        e.row = row_;
+        e.line = line;
+        e.byte_offset = byte_offset;
+        e.t_before = last_;
+        e.t_after = t;
+        e.dt = dt;
+        events_.push_back(e);
+        last_event_row_ = row_;
+    }
+
+    TimeAxisReport TimeAxisAccumulator::report() const
+    {
+        TimeAxisReport rep{};
+
+        if (dt_stats_.count() > 0)
+        {
+            rep.dt_ms.count = dt_stats_.count();
+            rep.dt_ms.min = dt_stats_.min();
+            rep.dt_ms.max = dt_stats_.max();
+            rep.dt_ms.mean = dt_stats_.mean();
+            rep.dt_ms.std = dt_stats_.stddev();
+        }
+
+        rep.dt_available = (rep.dt_ms.count > 0) && (rep.dt_ms.mean > EPS);
+
+        if (rep.dt_available)
+        {
+            rep.dt_median_ms = dt_hist_.median();
+            rep.dt_mode_ms = dt_hist_.mode();
+            // the median ignores the gaps and bursts that drag the mean around
+            rep.sampling_hz_est = rep.dt_median_ms > EPS ? (1000.0 / rep.dt_median_ms) : 0.0;
+        }
+        rep.anomalies = anomalies_;
+        rep.events = events_;
+        rep.events_dropped = events_dropped_;
         return rep;
     }
 
-}
\ No newline at end of file
+    TimeAxisReport make_time_axis_report_streaming(const TimestampStream &stream)
+    {
+        TimeAxisAccumulator acc;
+        stream([&](double t) { acc.update(t); });
+        return acc.report();
+    }
+
+}
@@ -13,4 +13,53 @@ std::string_view trim(std::string_view s)
     return s.substr(start, end - start + 1);
 }
 
+std::size_t utf8_sequence_length(std::string_view s, std::size_t i)
+{
+    const auto byte = [&](std::size_t k) { return static_cast<unsigned char>(s[k]); };
+    const unsigned char c = byte(i);
+
+    if (c < 0x80)
+        return 1;
+
+    std::size_t n = 0;
+    unsigned char lo = 0x80, hi = 0xBF;   // range of the second byte
+    if (c >= 0xC2 && c <= 0xDF) n = 2;
+    else if (c == 0xE0) { n = 3; lo = 0xA0; }
+    else if (c == 0xED) { n = 3; hi = 0x9F; }
+    else if (c >= 0xE1 && c <= 0xEF) n = 3;
+    else if (c == 0xF0) { n = 4; lo = 0x90; }
+    else if (c == 0xF4) { n = 4; hi = 0x8F; }
+    else if (c >= 0xF1 && c <= 0xF3) n = 4;
+    else return 0;
+
+    if (i + n > s.size() || byte(i + 1) < lo || byte(i + 1) > hi)
+        return 0;
+    for (std::size_t k = 2; k < n; ++k)
+    {
+        if (byte(i + k) < 0x80 || byte(i + k) > 0xBF)
+            return 0;
+    }
+    return n;
+}
+
+std::string to_valid_utf8(std::string_view s)
+{
+    std::string out;
+    out.reserve(s.size());
+
+    for (std::size_t i = 0; i < s.size();)
+    {
+        const std::size_t n = utf8_sequence_length(s, i);
+        if (n == 0)
+        {
+            out += UTF8_REPLACEMENT;
+            i++;
+            continue;
+        }
+        out.append(s.data() + i, n);
+        i += n;
+    }
+    return out;
+}
+
 }
\ No newline at end of file
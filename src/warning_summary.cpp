@@ -0,0 +1,113 @@
+#include "sla/warning_summary.hpp"
+#include "sla/util.hpp"   // utf8_sequence_length
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+
+namespace sla
+{
+    // Built once; categories only hand out views into it
+    static const std::array<std::string, WARNING_MAX_COLUMNS + 1> &column_count_messages()
+    {
+        static const auto table = []
+        {
+            std::array<std::string, WARNING_MAX_COLUMNS + 1> t;
+            for (std::size_t n = 0; n < WARNING_MAX_COLUMNS; ++n)
+                t[n] = "incorrect number of columns (expected 4, got " + std::to_string(n) + ")";
+            t[WARNING_MAX_COLUMNS] = "incorrect number of columns (expected 4, got " +
+                                     std::to_string(WARNING_MAX_COLUMNS) + " or more)";
+            return t;
+        }();
+        return table;
+    }
+
+    std::string_view warning_message(WarningKind kind, std::size_t detail)
+    {
+        if (kind == WarningKind::InvalidValue)
+            return "invalid value";
+        return column_count_messages()[std::min(detail, WARNING_MAX_COLUMNS)];
+    }
+
+    // Copies whole UTF-8 characters while they fit; a byte that isn't part of
+    // one (Latin-1, binary junk) becomes U+FFFD, so the report stays valid JSON
+    static void fill_sample(WarningSample &s, std::uint64_t line, std::string_view text)
+    {
+        std::size_t in = 0;
+        std::size_t n = 0;
+
+        while (in < text.size())
+        {
+            const std::size_t len = utf8_sequence_length(text, in);
+            const std::string_view ch = len ? text.substr(in, len) : UTF8_REPLACEMENT;
+            if (n + ch.size() > WARNING_TEXT_MAX)
+                break;
+
+            std::memcpy(s.text_buf.data() + n, ch.data(), ch.size());
+            n += ch.size();
+            in += len ? len : 1;
+        }
+
+        s.line = line;
+        s.text_size = static_cast<std::uint8_t>(n);
+        s.truncated = in < text.size();
+    }
+
+    // splitmix64
+    std::uint64_t WarningSummary::next_random()
+    {
+        std::uint64_t z = (rng_state_ += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    void WarningSummary::add(WarningKind kind, std::size_t detail, std::uint64_t line, std::string_view text)
+    {
+        if (kind == WarningKind::ColumnCount)
+            detail = std::min(detail, WARNING_MAX_COLUMNS);
+
+        // a handful of categories at most: a linear scan beats a map
+        auto it = std::find_if(categories_.begin(), categories_.end(), [&](const WarningCategory &c)
+                               { return c.kind == kind && c.detail == detail; });
+        if (it == categories_.end())
+        {
+            categories_.emplace_back();
+            it = categories_.end() - 1;
+            it->kind = kind;
+            it->detail = detail;
+            it->first_line = line;
+        }
+
+        WarningCategory &c = *it;
+        c.count++;
+        c.last_line = line;
+
+        if (c.sample_count < WARNING_SAMPLES)
+        {
+            fill_sample(c.samples[c.sample_count++], line, text);
+            return;
+        }
+
+        // keep the line with probability WARNING_SAMPLES / count
+        const std::uint64_t j = next_random() % c.count;
+        if (j < WARNING_SAMPLES)
+            fill_sample(c.samples[j], line, text);
+    }
+
+    std::vector<WarningCategory> WarningSummary::take()
+    {
+        std::sort(categories_.begin(), categories_.end(), [](const WarningCategory &a, const WarningCategory &b)
+                  { return a.kind != b.kind ? a.kind < b.kind : a.detail < b.detail; });
+
+        for (auto &c : categories_)
+        {
+            std::sort(c.samples.begin(), c.samples.begin() + static_cast<std::ptrdiff_t>(c.sample_count),
+                      [](const WarningSample &a, const WarningSample &b) { return a.line < b.line; });
+        }
+
+        return std::exchange(categories_, {});
+    }
+
+}
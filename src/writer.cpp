@@ -1,14 +1,25 @@
 #include "sla/writer.hpp"
+#include "sla/input_source.hpp"   // is_stdio_path
 
 #include <string>
-#include <iomanip>
+#include <charconv>
+#include <cstring>
 #include <limits>
 
 
 namespace sla{
 
-std::filesystem::path make_calib_path(const std::filesystem::path &input)
+std::filesystem::path strip_compression_extension(const std::filesystem::path &input)
 {
+    const auto ext = input.extension();
+    if (ext == ".gz" || ext == ".zst")
+        return input.parent_path() / input.stem();
+    return input;
+}
+
+std::filesystem::path make_calib_path(const std::filesystem::path &compressed_input)
+{
+    const auto input = strip_compression_extension(compressed_input);
     const auto parent = input.parent_path();
     const auto stem = input.stem().string();
     const auto ext = input.extension().string();
@@ -17,9 +28,21 @@ std::filesystem::path make_calib_path(const std::filesystem::path &input)
     return parent / out_name;
 }
 
-std::filesystem::path make_clean_path(const std::filesystem::path &input)
+std::filesystem::path make_resample_path(const std::filesystem::path &compressed_input)
 {
-    // input: data/imu_dirty.csv
+    const auto input = strip_compression_extension(compressed_input);
+    const auto parent = input.parent_path();
+    const auto stem = input.stem().string();
+    const auto ext = input.extension().string();
+
+    std::string out_name = stem + "_resampled" + ext;
+    return parent / out_name;
+}
+
+std::filesystem::path make_clean_path(const std::filesystem::path &compressed_input)
+{
+    // input: data/imu_dirty.csv (or data/imu_dirty.csv.gz)
+    const auto input = strip_compression_extension(compressed_input);
 
     const auto parent = input.parent_path();          // "data"
     const auto stem = input.stem().string();          // "imu_dirty"
@@ -29,43 +52,139 @@ std::filesystem::path make_clean_path(const std::filesystem::path &input)
     return parent / out_name;                         // "data/imu_dirty_clean.csv"
 }
 
-bool CsvWriter::open(const std::filesystem::path &out_path)
+BufferedWriter::BufferedWriter(std::size_t capacity)
+    : buf_(capacity < 64 ? 64 : capacity)
 {
-    path_ = out_path;
+}
 
-    // std::ios::out — mode: output (writing)
-    // | — bitwise “or” (flag union)
-    // std::ios::trunc — mode: truncate (delete old content)
-    out_.open(path_, std::ios::out | std::ios::trunc);
+BufferedWriter::~BufferedWriter()
+{
+    close();
+}
 
-    if (!out_.is_open()) return false;
-    
-    out_ << std::setprecision(std::numeric_limits<double>::max_digits10);
+bool BufferedWriter::open(const std::filesystem::path &out_path)
+{
+    close();
 
+    owned_ = !is_stdio_path(out_path);
+    file_ = owned_ ? std::fopen(out_path.string().c_str(), "wb") : stdout;
+    if (!file_) return false;
+
+    // we do our own buffering
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+
+    used_ = 0;
+    bytes_ = 0;
+    ok_ = true;
     return true;
 }
 
+void BufferedWriter::reserve(std::size_t n)
+{
+    if (buf_.size() - used_ < n)
+        flush();
+}
+
+void BufferedWriter::write(std::string_view s)
+{
+    if (s.size() >= buf_.size())
+    {
+        // too big to be worth copying
+        flush();
+        if (file_ && std::fwrite(s.data(), 1, s.size(), file_) != s.size())
+            ok_ = false;
+        bytes_ += s.size();
+        return;
+    }
+
+    reserve(s.size());
+    std::memcpy(buf_.data() + used_, s.data(), s.size());
+    used_ += s.size();
+}
+
+void BufferedWriter::write_char(char c)
+{
+    reserve(1);
+    buf_[used_++] = c;
+}
+
+void BufferedWriter::write_double(double v)
+{
+    // 32 bytes fit any shortest double ("-2.2250738585072014e-308" is 24)
+    reserve(32);
+    char *first = buf_.data() + used_;
+    auto res = std::to_chars(first, first + 32, v);
+    used_ += static_cast<std::size_t>(res.ptr - first);
+}
+
+void BufferedWriter::write_double(double v, int precision)
+{
+    // %.17g of the longest double is 24 chars
+    reserve(40);
+    char *first = buf_.data() + used_;
+    auto res = std::to_chars(first, first + 40, v, std::chars_format::general, precision);
+    used_ += static_cast<std::size_t>(res.ptr - first);
+}
+
+void BufferedWriter::flush()
+{
+    if (used_ == 0) return;
+
+    if (file_ && std::fwrite(buf_.data(), 1, used_, file_) != used_)
+        ok_ = false;
+
+    bytes_ += used_;
+    used_ = 0;
+}
+
+void BufferedWriter::close()
+{
+    if (!file_) return;
+
+    flush();
+    if (owned_ ? std::fclose(file_) != 0 : std::fflush(file_) != 0)
+        ok_ = false;
+    file_ = nullptr;
+}
+
+bool CsvWriter::open(const std::filesystem::path &out_path)
+{
+    path_ = out_path;
+
+    // fopen("wb") truncates old content, like std::ios::trunc
+    return out_.open(path_);
+}
+
 void CsvWriter::write_header(const std::array<std::string_view, 4> &header)
 {
     for (size_t i = 0; i < header.size(); i++)
     {
-        out_ << header[i];
-        if (i + 1 < header.size())  out_ << ',';
+        out_.write(header[i]);
+        if (i + 1 < header.size())  out_.write_char(',');
     }
 
-    out_ << '\n';
+    out_.write_char('\n');
 }
 
 void CsvWriter::write_row(const std::array<double, 4> &v)
 {
-    out_ << v[0] << ',' << v[1] << ',' << v[2] << ',' << v[3] << '\n';
-    
+    // max_digits10 (17) significant digits: same text as the old
+    // ofstream << setprecision(max_digits10), round-trips exactly
+    constexpr int P = std::numeric_limits<double>::max_digits10;
+
+    out_.write_double(v[0], P);
+    out_.write_char(',');
+    out_.write_double(v[1], P);
+    out_.write_char(',');
+    out_.write_double(v[2], P);
+    out_.write_char(',');
+    out_.write_double(v[3], P);
+    out_.write_char('\n');
 }
 
 void CsvWriter::close()
 {
-    if (out_.is_open())
-        out_.close();
+    out_.close();
 }
 
 
@@ -0,0 +1,90 @@
+#include "sla/allan.hpp"
+#include "sla/synth.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// Cluster averages computed directly: O(N * m)
+static double brute_force_adev(const std::vector<double> &y, std::uint64_t m)
+{
+    const std::uint64_t n = y.size();
+    double acc = 0.0;
+    std::uint64_t terms = 0;
+
+    for (std::uint64_t k = 0; k + 2 * m <= n; ++k)
+    {
+        double a = 0.0, b = 0.0;
+        for (std::uint64_t i = 0; i < m; ++i)
+        {
+            a += y[k + i];
+            b += y[k + m + i];
+        }
+        const double d = (b - a) / static_cast<double>(m);
+        acc += d * d;
+        terms++;
+    }
+    return std::sqrt(acc / (2.0 * static_cast<double>(terms)));
+}
+
+TEST_CASE("allan: cluster sizes are log-spaced and unique")
+{
+    auto ms = sla::allan_cluster_sizes(1000, 4);
+    CHECK(ms == std::vector<std::uint64_t>{1, 3, 5, 10, 17, 31, 56, 100, 177, 316});
+
+    CHECK(sla::allan_cluster_sizes(2, 10).empty());
+    CHECK(sla::allan_cluster_sizes(7, 10).back() == 3);
+}
+
+TEST_CASE("allan: prefix-sum ADEV matches cluster averaging")
+{
+    sla::SplitMix64 rng(7);
+    std::vector<double> y(500);
+    for (auto &v : y)
+        v = 9.81 + rng.symmetric(0.01);
+
+    std::vector<double> cum{0.0};
+    for (double v : y)
+        cum.push_back(cum.back() + (v - y[0]));
+
+    for (std::uint64_t m : {1, 2, 7, 50, 250})
+        CHECK(sla::overlapping_adev(cum, m) == Catch::Approx(brute_force_adev(y, m)).epsilon(1e-9));
+
+    CHECK(sla::overlapping_adev(cum, 251) == 0.0);   // not two full clusters
+}
+
+TEST_CASE("allan: white noise falls as 1/sqrt(tau), threads don't change the result")
+{
+    const auto path = std::filesystem::temp_directory_path() / "sla_test_allan.csv";
+
+    sla::SynthOptions g;
+    g.rows = 20000;
+    g.rate_hz = 100.0;
+    g.noise = 0.01;
+    REQUIRE(sla::write_synthetic_csv(g, path).ok);
+
+    sla::AllanOptions opt;
+    opt.input_path = path;
+    opt.threads = 1;
+    auto one = sla::run_allan(opt);
+    opt.threads = 4;
+    auto four = sla::run_allan(opt);
+    std::filesystem::remove(path);
+
+    REQUIRE(one.ok);
+    CHECK(one.tau0_s == Catch::Approx(0.01));
+    REQUIRE(one.points.size() == four.points.size());
+    for (std::size_t i = 0; i < one.points.size(); ++i)
+        CHECK(one.points[i].adev == four.points[i].adev);
+
+    // uniform noise +-0.01: sigma = 0.01 / sqrt(3); ADEV(m) ~ sigma / sqrt(m)
+    const double sigma = 0.01 / std::sqrt(3.0);
+    for (const auto &p : one.points)
+    {
+        if (p.m <= 100)
+            CHECK(p.adev[0] * std::sqrt(static_cast<double>(p.m)) == Catch::Approx(sigma).epsilon(0.15));
+    }
+}
@@ -0,0 +1,125 @@
+#include "sla/apply.hpp"
+#include "sla/synth.hpp"
+#include "sla/writer.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+TEST_CASE("apply: dispatched kernel matches the scalar one bit for bit")
+{
+    sla::Correction k;
+    k.C.a[0][0] = 0.99; k.C.a[0][1] = 0.003; k.C.a[0][2] = -0.002;
+    k.C.a[1][0] = -0.001; k.C.a[1][1] = 1.02; k.C.a[1][2] = 0.004;
+    k.C.a[2][0] = 0.002; k.C.a[2][1] = -0.005; k.C.a[2][2] = 0.985;
+    k.b = {-0.3, 0.12, 0.05};
+
+    const std::size_t n = 1003;   // not a multiple of the vector width
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> u(-20.0, 20.0);
+
+    std::vector<double> ax(n), ay(n), az(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        ax[i] = u(rng);
+        ay[i] = u(rng);
+        az[i] = u(rng);
+    }
+
+    std::vector<double> fx(n), fy(n), fz(n), sx(n), sy(n), sz(n);
+    sla::apply_correction(k, ax.data(), ay.data(), az.data(), fx.data(), fy.data(), fz.data(), n);
+    sla::apply_correction_scalar(k, ax.data(), ay.data(), az.data(), sx.data(), sy.data(), sz.data(), n);
+
+    CHECK(std::memcmp(fx.data(), sx.data(), n * sizeof(double)) == 0);
+    CHECK(std::memcmp(fy.data(), sy.data(), n * sizeof(double)) == 0);
+    CHECK(std::memcmp(fz.data(), sz.data(), n * sizeof(double)) == 0);
+
+    const double dx = ax[5] - k.b.x, dy = ay[5] - k.b.y, dz = az[5] - k.b.z;
+    CHECK(sy[5] == Catch::Approx(k.C.a[1][0] * dx + k.C.a[1][1] * dy + k.C.a[1][2] * dz));
+}
+
+TEST_CASE("apply: coefficients from a calib JSON, errors reported")
+{
+    const auto dir = std::filesystem::temp_directory_path();
+    const auto good = dir / "sla_test_apply_calib.json";
+    const auto bad = dir / "sla_test_apply_bad.json";
+    {
+        std::ofstream f(good);
+        f << R"({"meta": {}, "coeffs": {"C": [[1.0, 0.1, 0.0], [0.0, 2.0, 0.0], [0.0, 0.0, 3.0]],
+                 "M": [[1, 0, 0], [0, 1, 0], [0, 0, 1]], "b": {"x": 0.5, "y": -0.25, "z": 0.125}}})";
+    }
+    {
+        std::ofstream f(bad);
+        f << R"({"coeffs": {"C": [[1.0, 0.0], [0.0, 1.0]]}})";
+    }
+
+    sla::Correction k;
+    std::string err;
+    REQUIRE(sla::load_correction(good, k, err));
+    CHECK(k.C.a[0][1] == 0.1);
+    CHECK(k.C.a[2][2] == 3.0);
+    CHECK(k.b.x == 0.5);
+    CHECK(k.b.z == 0.125);
+
+    CHECK_FALSE(sla::load_correction(bad, k, err));
+    CHECK_FALSE(err.empty());
+
+    err.clear();
+    CHECK_FALSE(sla::load_correction(dir / "sla_test_apply_missing.json", k, err));
+    CHECK_FALSE(err.empty());
+
+    std::filesystem::remove(good);
+    std::filesystem::remove(bad);
+}
+
+TEST_CASE("apply: calib's corrected CSV is what apply writes from its report")
+{
+    const auto dir = std::filesystem::temp_directory_path() / "sla_test_apply_calib";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    {
+        std::ofstream f(dir / "POSITION.txt");
+        f << "INNER OUTER\n0 0\n0 90\n0 180\n0 270\n90 0\n90 90\n90 180\n90 270\n";
+    }
+
+    std::string err;
+    sla::SynthOptions gen;
+    gen.rows = 8003;
+    gen.positions = sla::read_position(dir / "POSITION.txt", err);
+    REQUIRE(err.empty());
+    REQUIRE(sla::write_synthetic_csv(gen, dir / "dev.csv").ok);
+
+    sla::CalibrationOptions opt;
+    opt.input_path = dir / "dev.csv";
+    opt.position_path = dir / "POSITION.txt";
+    opt.output_path = sla::make_calib_path(opt.input_path);
+    opt.verbose = false;
+
+    const auto calib = sla::run_calibration(opt);
+    REQUIRE(calib.ok);
+
+    sla::ApplyOptions ap;
+    ap.input_path = opt.input_path;
+    ap.coeffs_path = dir / "dev_calib.json";
+    ap.output_path = dir / "dev_applied.csv";
+    ap.max_rows = calib.used_lines;
+    REQUIRE(sla::run_apply(ap).ok);
+
+    auto slurp = [](const std::filesystem::path &p)
+    {
+        std::ifstream f(p, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    };
+    const std::string expected = slurp(opt.output_path);
+    CHECK_FALSE(expected.empty());
+    CHECK(slurp(ap.output_path) == expected);
+
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,96 @@
+#include "sla/calib_batch.hpp"
+#include "sla/synth.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+TEST_CASE("calib batch: every device fitted, outputs skipped, failures reported")
+{
+    const auto dir = std::filesystem::temp_directory_path() / "sla_test_calib_batch";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    {
+        std::ofstream f(dir / "POSITION.txt");
+        f << "INNER OUTER\n0 0\n0 90\n0 180\n0 270\n90 0\n90 90\n90 180\n90 270\n";
+    }
+
+    std::string err;
+    sla::SynthOptions gen;
+    gen.rows = 16000;
+    gen.positions = sla::read_position(dir / "POSITION.txt", err);
+    REQUIRE(err.empty());
+
+    for (std::uint64_t seed : {1, 2, 3})
+    {
+        gen.seed = seed;
+        REQUIRE(sla::write_synthetic_csv(gen, dir / ("dev" + std::to_string(seed) + ".csv")).ok);
+    }
+    {
+        std::ofstream f(dir / "dev4.csv");   // truncated capture: no usable rows
+        f << "t_ms,ax,ay,az\n";
+    }
+    {
+        std::ofstream f(dir / "old_calib.csv");   // output of an earlier run
+        f << "t_ms,ax,ay,az\n";
+    }
+    {
+        std::ofstream f(dir / "old_clean.csv");
+        f << "t_ms,ax,ay,az\n";
+    }
+    gen.seed = 5;   // a device whose name only contains "_calib"
+    REQUIRE(sla::write_synthetic_csv(gen, dir / "line3_calibration_rig.csv").ok);
+    gen.seed = 6;   // not an sla output: allan writes *_allan.json
+    REQUIRE(sla::write_synthetic_csv(gen, dir / "rig_allan.csv").ok);
+    {
+        std::ofstream f(dir / "dev1.csv.gz");   // would write dev1_calib.* too
+        f << "not read";
+    }
+
+    sla::BatchOptions opt;
+    opt.dir = dir;
+    opt.position_path = dir / "POSITION.txt";
+    opt.summary_path = sla::make_batch_summary_path(dir);
+    opt.threads = 2;
+
+    auto r = sla::run_calibration_batch(opt);
+    REQUIRE(r.ok);
+    REQUIRE(r.devices.size() == 6);
+    CHECK(r.passed == 5);
+    REQUIRE(r.skipped.size() == 3);
+    CHECK(r.skipped[0].input.filename() == "dev1.csv.gz");
+    CHECK(r.skipped[0].reason == "same outputs as dev1.csv");
+    CHECK(r.skipped[1].input.filename() == "old_calib.csv");
+    CHECK(r.skipped[2].input.filename() == "old_clean.csv");
+
+    CHECK(r.devices[0].input.filename() == "dev1.csv");
+    CHECK(r.devices[0].pass);
+    CHECK(r.devices[0].result.M.a[0][0] == Catch::Approx(1.01).epsilon(1e-3));
+    CHECK(r.devices[0].result.b.x == Catch::Approx(-0.3).epsilon(1e-2));
+    CHECK(std::filesystem::exists(dir / "dev1_calib.csv"));
+    CHECK(std::filesystem::exists(dir / "dev1_calib.json"));
+
+    CHECK_FALSE(r.devices[3].result.ok);
+    CHECK_FALSE(r.devices[3].pass);
+
+    CHECK(r.devices[4].input.filename() == "line3_calibration_rig.csv");
+    CHECK(r.devices[4].pass);
+    CHECK(r.devices[5].input.filename() == "rig_allan.csv");
+    CHECK(r.devices[5].pass);
+
+    REQUIRE(sla::write_batch_summary(r, opt.summary_path, err));
+    std::ifstream summary(opt.summary_path);
+    std::string line;
+    int lines = 0;
+    while (std::getline(summary, line))
+        lines++;
+    CHECK(lines == 7);
+
+    // a rerun doesn't pick up its own outputs
+    CHECK(sla::list_batch_inputs(dir, opt.summary_path).size() == 6);
+
+    std::filesystem::remove_all(dir);
+}
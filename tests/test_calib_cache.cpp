@@ -0,0 +1,124 @@
+#include "sla/calib_cache.hpp"
+#include "sla/synth.hpp"
+#include "sla/writer.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <string>
+
+static std::string slurp(const std::filesystem::path &p)
+{
+    std::ifstream f(p, std::ios::binary);
+    return {std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>()};
+}
+
+TEST_CASE("calib cache: a hit skips the fit and restores the outputs")
+{
+    const auto dir = std::filesystem::temp_directory_path() / "sla_test_calib_cache";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    {
+        std::ofstream f(dir / "POSITION.txt");
+        f << "INNER OUTER\n0 0\n0 90\n0 180\n0 270\n90 0\n90 90\n90 180\n90 270\n";
+    }
+
+    std::string err;
+    sla::SynthOptions gen;
+    gen.rows = 16005;   // the 5-row tail is not in the corrected CSV
+    gen.positions = sla::read_position(dir / "POSITION.txt", err);
+    REQUIRE(err.empty());
+    REQUIRE(sla::write_synthetic_csv(gen, dir / "dev.csv").ok);
+
+    sla::CalibrationOptions opt;
+    opt.input_path = dir / "dev.csv";
+    opt.position_path = dir / "POSITION.txt";
+    opt.output_path = sla::make_calib_path(opt.input_path);
+    opt.cache_dir = dir / "cache";
+    opt.verbose = false;
+
+    const auto json_path = dir / "dev_calib.json";
+
+    auto first = sla::run_calibration(opt);
+    REQUIRE(first.ok);
+    CHECK_FALSE(first.cache_hit);
+    CHECK(first.used_lines == 16000);
+    REQUIRE(first.means.size() == 8);
+
+    const std::string csv = slurp(opt.output_path);
+    const std::string report = slurp(json_path);
+
+    auto second = sla::run_calibration(opt);
+    REQUIRE(second.ok);
+    CHECK(second.cache_hit);
+    CHECK(second.M.a[1][2] == first.M.a[1][2]);
+    CHECK(second.b.z == first.b.z);
+    CHECK(second.means[3].y == first.means[3].y);
+    CHECK(second.mag_corr_stats.std == first.mag_corr_stats.std);
+
+    // only the CSV is gone: the apply pass writes the same bytes
+    std::filesystem::remove(opt.output_path);
+    std::filesystem::remove(json_path);
+    auto third = sla::run_calibration(opt);
+    REQUIRE(third.ok);
+    CHECK(third.cache_hit);
+    CHECK(slurp(opt.output_path) == csv);
+    CHECK(slurp(json_path) == report);
+
+    // other settings, other key
+    std::uint64_t k1{}, k2{};
+    sla::CalibrationPositions pos;
+    REQUIRE(sla::load_calibration_positions(opt.position_path, opt.gravity, pos, err));
+    REQUIRE(sla::calib_cache_key(opt, pos, k1));
+    opt.steady_end_frac = 0.6;
+    REQUIRE(sla::calib_cache_key(opt, pos, k2));
+    CHECK(k1 != k2);
+
+    auto other = sla::run_calibration(opt);
+    REQUIRE(other.ok);
+    CHECK_FALSE(other.cache_hit);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("calib cache: NaN and infinity survive a store and load")
+{
+    const auto dir = std::filesystem::temp_directory_path() / "sla_test_calib_cache_nan";
+    std::filesystem::remove_all(dir);
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+
+    sla::CalibCacheEntry e;
+    e.key = 0x1234;
+    e.report = "{}";
+    e.result.npos = 1;
+    e.result.means = {{1.0, 2.0, 3.0}};
+    e.result.design_cond = inf;
+    e.result.M.a[0][0] = 1.5;
+    e.result.b.y = -inf;
+    e.result.bootstrap.replicates = 4;
+    e.result.bootstrap.spread.se.fill(nan);
+    e.result.bootstrap.spread.se[3] = 0.25;
+    e.result.bootstrap.spread.p2_5.fill(nan);
+    e.result.bootstrap.spread.p97_5.fill(nan);
+
+    std::string err;
+    REQUIRE(sla::store_calib_cache_entry(dir, e, err));
+
+    sla::CalibCacheEntry back;
+    REQUIRE(sla::load_calib_cache_entry(dir, e.key, back));
+    CHECK(back.result.design_cond == inf);
+    CHECK(back.result.b.y == -inf);
+    CHECK(back.result.M.a[0][0] == 1.5);
+    CHECK(std::isnan(back.result.bootstrap.spread.se[0]));
+    CHECK(back.result.bootstrap.spread.se[3] == 0.25);
+    CHECK(std::isnan(back.result.bootstrap.spread.p97_5[23]));
+    CHECK(back.result.means[0].z == 3.0);
+
+    std::filesystem::remove_all(dir);
+}
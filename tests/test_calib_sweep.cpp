@@ -0,0 +1,35 @@
+#include "sla/calib_sweep.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+TEST_CASE("sub-block sums: exact ranges while rows fit in the chunk budget")
+{
+    sla::SubBlockSums s(64);
+    for (int i = 0; i < 50; ++i)
+        s.add(10.0 + i, 1.0, -i);
+    s.finish();
+
+    CHECK(s.rows() == 50);
+    CHECK(s.chunk_rows() == 1);
+
+    const auto m = s.range(10, 20);   // values 20..29 -> relative 10..19
+    CHECK(m.n == 10);
+    CHECK(m.sum[0] == Catch::Approx(145.0));
+    CHECK(m.sum[1] == 0.0);
+    CHECK(m.sum_sq[2] == Catch::Approx(2185.0));   // sum of 10^2..19^2
+}
+
+TEST_CASE("sub-block sums: chunks double and ranges round to their boundaries")
+{
+    sla::SubBlockSums s(8);
+    for (int i = 0; i < 100; ++i)
+        s.add(i, 0.0, 0.0);
+    s.finish();
+
+    CHECK(s.chunk_rows() == 16);   // 1 -> 2 -> 4 -> 8 -> 16 as chunks hit 8
+    CHECK(s.range(0, 100).n == 100);
+    CHECK(s.range(15, 33).n == 16);   // [16, 32)
+    CHECK(s.range(40, 41).n == 0);    // both ends round to 48
+    CHECK(s.range(96, 200).n == 4);   // partial last chunk
+}
@@ -0,0 +1,98 @@
+#include "sla/hampel.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+static double slow_median(std::vector<double> v)
+{
+    std::sort(v.begin(), v.end());
+    const std::size_t n = v.size();
+    return (n % 2) ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+TEST_CASE("rolling median/MAD matches sorting the window")
+{
+    for (std::size_t w : {1, 2, 5, 8})
+    {
+        sla::RollingMedianMad r(w);
+        std::vector<double> all;
+
+        for (int i = 0; i < 60; ++i)
+        {
+            const double x = std::fmod(i * 7.3, 11.0) - (i % 4 == 0 ? 3.0 : 0.0);
+            r.push(x);
+            all.push_back(x);
+
+            const std::vector<double> win(all.end() - std::min(all.size(), w), all.end());
+            const double med = slow_median(win);
+            std::vector<double> dev;
+            for (double v : win)
+                dev.push_back(std::abs(v - med));
+
+            CHECK(r.median() == Catch::Approx(med));
+            CHECK(r.mad() == Catch::Approx(slow_median(dev)));
+        }
+    }
+}
+
+using Row = std::array<double, 4>;
+
+static std::vector<Row> run_hampel(sla::HampelMode mode, sla::HampelStats &stats)
+{
+    sla::HampelOptions opt;
+    opt.half_window = 3;
+    opt.mode = mode;
+
+    std::vector<Row> out;
+    sla::HampelFilter f(opt, [&](const Row &r) { out.push_back(r); });
+    for (int i = 0; i < 40; ++i)
+    {
+        const double noise = (i % 3 - 1) * 0.01;
+        f.push({double(i), 9.81 + noise, (i == 20 ? 50.0 : noise), noise});
+    }
+    f.flush();
+    stats = f.stats();
+    return out;
+}
+
+TEST_CASE("hampel: spike is replaced, flagged or dropped; row order is kept")
+{
+    sla::HampelStats st;
+
+    auto out = run_hampel(sla::HampelMode::Replace, st);
+    REQUIRE(out.size() == 40);
+    for (int i = 0; i < 40; ++i)
+        CHECK(out[i][0] == double(i));
+    CHECK(st.outliers == 1);
+    CHECK(st.values_replaced == 1);
+    CHECK(std::abs(out[20][2]) <= 0.01);
+    CHECK(out[20][1] == Catch::Approx(9.81 + 0.01));   // other axes untouched
+
+    out = run_hampel(sla::HampelMode::Flag, st);
+    CHECK(out.size() == 40);
+    CHECK(out[20][2] == 50.0);
+    CHECK(st.outliers == 1);
+
+    out = run_hampel(sla::HampelMode::Drop, st);
+    CHECK(out.size() == 39);
+    CHECK(st.rows_dropped == 1);
+}
+
+TEST_CASE("hampel: input shorter than the window passes through")
+{
+    sla::HampelOptions opt;
+    opt.half_window = 10;
+
+    std::vector<Row> out;
+    sla::HampelFilter f(opt, [&](const Row &r) { out.push_back(r); });
+    f.push({0, 1, 1, 1});
+    f.push({1, 100, 1, 1});
+    f.flush();
+
+    CHECK(out.size() == 2);
+    CHECK(out[1][1] == 100.0);
+}
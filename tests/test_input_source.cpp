@@ -0,0 +1,168 @@
+#include "sla/input_source.hpp"
+#include "sla/csv.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+#include <zstd.h>
+
+// In-memory source that hands out at most `step` bytes per read
+class MemorySource : public sla::InputSource
+{
+public:
+    MemorySource(std::string data, std::size_t step) : data_(std::move(data)), step_(step) {}
+
+    std::size_t read(char *dst, std::size_t n) override
+    {
+        const std::size_t k = std::min({n, step_, data_.size() - pos_});
+        std::memcpy(dst, data_.data() + pos_, k);
+        pos_ += k;
+        return k;
+    }
+
+    std::string error() const override { return {}; }
+    sla::Compression compression() const override { return sla::Compression::None; }
+
+private:
+    std::string data_;
+    std::size_t step_;
+    std::size_t pos_{0};
+};
+
+static std::vector<std::string> read_lines(const std::string &data, std::size_t step, std::size_t buffer)
+{
+    MemorySource src(data, step);
+    sla::LineReader lr(src, buffer);
+
+    std::vector<std::string> out;
+    std::string_view line;
+    while (lr.next(line))
+        out.emplace_back(line);
+    return out;
+}
+
+static std::string sample_csv()
+{
+    std::string s = "t_ms,ax,ay,az\n";
+    for (int i = 0; i < 5000; ++i)
+        s += std::to_string(i * 10) + ",0.5,-0.25,9.81\n";
+    s += "1,2,3\n"; // bad line
+    return s;
+}
+
+TEST_CASE("detect_compression by magic bytes")
+{
+    const unsigned char gz[] = {0x1f, 0x8b, 0x08, 0x00};
+    const unsigned char zst[] = {0x28, 0xb5, 0x2f, 0xfd};
+    const unsigned char csv[] = {'t', '_', 'm', 's'};
+
+    CHECK(sla::detect_compression(gz, 4) == sla::Compression::Gzip);
+    CHECK(sla::detect_compression(zst, 4) == sla::Compression::Zstd);
+    CHECK(sla::detect_compression(csv, 4) == sla::Compression::None);
+    CHECK(sla::detect_compression(zst, 2) == sla::Compression::None);
+}
+
+TEST_CASE("LineReader behaves like getline across buffer boundaries")
+{
+    using V = std::vector<std::string>;
+
+    CHECK(read_lines("a\nbb\nccc\n", 1, 16) == V{"a", "bb", "ccc"});
+    CHECK(read_lines("a\nbb\nccc", 2, 16) == V{"a", "bb", "ccc"});   // no trailing '\n'
+    CHECK(read_lines("a\r\n\nb\n", 3, 16) == V{"a\r", "", "b"});
+    CHECK(read_lines("", 4, 16).empty());
+
+    // line longer than the buffer
+    const std::string long_line(100, 'x');
+    CHECK(read_lines(long_line + "\ny\n", 7, 16) == V{long_line, "y"});
+}
+
+TEST_CASE("LineReader reports line byte offsets")
+{
+    MemorySource src("ab\ncde\nf", 2);
+    sla::LineReader lr(src, 16);
+    std::string_view line;
+
+    REQUIRE(lr.next(line));
+    CHECK(lr.line_offset() == 0);
+    REQUIRE(lr.next(line));
+    CHECK(lr.line_offset() == 3);
+    REQUIRE(lr.next(line));
+    CHECK(lr.line_offset() == 7);
+}
+
+TEST_CASE("gzip and zstd inputs parse like the plain file")
+{
+    const auto dir = std::filesystem::temp_directory_path();
+    const auto plain = dir / "sla_test_input.csv";
+    const auto gz = dir / "sla_test_input.csv.gz";
+    const auto zst = dir / "sla_test_input.csv.zst";
+    const std::string data = sample_csv();
+
+    {
+        std::ofstream(plain, std::ios::binary) << data;
+
+        gzFile g = gzopen(gz.string().c_str(), "wb");
+        REQUIRE(g != nullptr);
+        gzwrite(g, data.data(), static_cast<unsigned>(data.size()));
+        gzclose(g);
+
+        std::vector<char> buf(ZSTD_compressBound(data.size()));
+        const std::size_t n = ZSTD_compress(buf.data(), buf.size(), data.data(), data.size(), 3);
+        REQUIRE_FALSE(ZSTD_isError(n));
+        std::ofstream(zst, std::ios::binary).write(buf.data(), static_cast<std::streamsize>(n));
+    }
+
+    auto expected = sla::read_imu_csv_streaming(plain, {});
+    REQUIRE(expected.ok);
+    CHECK(expected.counts.parsed_lines == 5000);
+
+    for (const auto &p : {gz, zst})
+    {
+        double sum_t = 0.0;
+        auto r = sla::read_imu_csv_streaming(p, [&](const std::array<double, 4> &row) { sum_t += row[0]; });
+
+        REQUIRE(r.ok);
+        CHECK(r.counts.total_lines == expected.counts.total_lines);
+        CHECK(r.counts.parsed_lines == expected.counts.parsed_lines);
+        CHECK(r.counts.bad_lines == expected.counts.bad_lines);
+        CHECK(sum_t == 10.0 * 4999 * 5000 / 2);
+    }
+
+    std::filesystem::remove(plain);
+    std::filesystem::remove(gz);
+    std::filesystem::remove(zst);
+}
+
+TEST_CASE("truncated gzip is reported as an error")
+{
+    const auto gz = std::filesystem::temp_directory_path() / "sla_test_truncated.csv.gz";
+    const std::string data = sample_csv();
+
+    std::vector<unsigned char> buf(compressBound(static_cast<uLong>(data.size())) + 32);
+    z_stream zs{};
+    REQUIRE(deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+    zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    zs.avail_in = static_cast<uInt>(data.size());
+    zs.next_out = buf.data();
+    zs.avail_out = static_cast<uInt>(buf.size());
+    REQUIRE(deflate(&zs, Z_FINISH) == Z_STREAM_END);
+    const std::size_t n = buf.size() - zs.avail_out;
+    deflateEnd(&zs);
+
+    // drop the tail (crc + size + some data)
+    std::ofstream(gz, std::ios::binary).write(reinterpret_cast<const char *>(buf.data()),
+                                              static_cast<std::streamsize>(n / 2));
+
+    auto r = sla::read_imu_csv_streaming(gz, {});
+    std::filesystem::remove(gz);
+
+    CHECK_FALSE(r.ok);
+    CHECK(r.error.find("gzip") != std::string::npos);
+}
@@ -0,0 +1,126 @@
+#include "sla/json_writer.hpp"
+#include "sla/report_json.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST_CASE("json writer: same bytes as nlohmann dump(4)")
+{
+    const std::vector<double> doubles{0.0, -0.0, 1.0, 0.1, -2.5, 1e-7, 1.5e-5, 123456789012345.0, 1e16, 1e21,
+                                      5e-324, std::numeric_limits<double>::max(), 9.81054, 1.0 / 3.0,
+                                      std::nan(""), std::numeric_limits<double>::infinity()};
+    const std::vector<std::string> strings{"", "plain", "quote \" backslash \\ slash /", "tab\tnl\ncr\rbs\bff\f",
+                                           std::string("nul\0x\x01\x1f\x7f", 9), "\xc3\xa9t\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80"};
+
+    nlohmann::ordered_json j;
+    j["doubles"] = doubles;
+    j["strings"] = strings;
+    j["ints"] = {0, -1, std::numeric_limits<std::int64_t>::min()};
+    j["u64"] = std::numeric_limits<std::uint64_t>::max();
+    j["flags"] = {true, false, nullptr};
+    j["empty_array"] = nlohmann::ordered_json::array();
+    j["empty_object"] = nlohmann::ordered_json::object();
+    j["nested"] = {{"a", {{"b", nlohmann::ordered_json::array({1, 2})}}}};
+
+    std::string out;
+    sla::JsonWriter w(out);
+    w.begin_object();
+    w.field("doubles", doubles);
+    w.field("strings", strings);
+    w.key("ints");
+    w.begin_array();
+    w.value(0);
+    w.value(-1);
+    w.value(std::numeric_limits<std::int64_t>::min());
+    w.end_array();
+    w.field("u64", std::numeric_limits<std::uint64_t>::max());
+    w.key("flags");
+    w.begin_array();
+    w.value(true);
+    w.value(false);
+    w.value(nullptr);
+    w.end_array();
+    w.key("empty_array");
+    w.begin_array();
+    w.end_array();
+    w.key("empty_object");
+    w.begin_object();
+    w.end_object();
+    w.key("nested");
+    w.begin_object();
+    w.key("a");
+    w.begin_object();
+    w.field("b", std::vector<int>{1, 2});
+    w.end_object();
+    w.end_object();
+    w.end_object();
+
+    CHECK(out == j.dump(4));
+
+    // invalid UTF-8 is an error, as in dump()
+    for (const std::string bad : {"\xff", "\xc3", "\xc0\xaf", "\xed\xa0\x80", "\xf4\x90\x80\x80"})
+    {
+        std::string s;
+        sla::JsonWriter bw(s);
+        CHECK_THROWS_AS(bw.value(bad), std::runtime_error);
+        CHECK_THROWS(nlohmann::json(bad).dump(4));
+    }
+}
+
+TEST_CASE("json writer: streamed report matches report_to_json")
+{
+    sla::Report r;
+    r.input = "imu \"dirty\".csv";
+    r.counts.total_lines = 1003;
+    r.counts.parsed_lines = 998;
+    r.counts.bad_lines = 2;
+    r.warnings.push_back({"invalid value", 14, 3, std::string("ab\tc")});
+    r.warnings.push_back({"incorrect number of columns (expected 4, got 3)", 20, std::nullopt, std::nullopt});
+    r.warnings_dropped = 7;
+
+    sla::WarningSummary summary;
+    summary.add(sla::WarningKind::InvalidValue, 3, 14, "ab\tc");
+    summary.add(sla::WarningKind::ColumnCount, 3, 20, "1,2,3");
+    summary.add(sla::WarningKind::ColumnCount, 90, 21, std::string(100, ','));
+    r.warning_categories = summary.take();
+
+    r.time_axis.dt_available = true;
+    r.time_axis.dt_ms = {997, 9.5, 10.5, 10.0, 0.1};
+    r.time_axis.dt_median_ms = 10.0;
+    r.time_axis.dt_mode_ms = 10.0;
+    r.time_axis.sampling_hz_est = 100.0;
+    r.time_axis.anomalies.gaps = 1;
+    sla::TimeAxisEvent e;
+    e.kind = sla::TimeAxisEventKind::Gap;
+    e.row = 41;
+    e.line = 43;
+    e.byte_offset = 1187;
+    e.t_before = 400.0;
+    e.t_after = 520.0;
+    e.dt = 120.0;
+    r.time_axis.events.push_back(e);
+
+    r.statistics.ax = {998, -0.1, 0.1, 1e-3, std::nan("")};
+    r.reorder = sla::ReorderStats{64, 3, 1, 0};
+
+    sla::PsdReport p;
+    p.window = 4;
+    p.segments = 2;
+    p.fs_hz = 100.0;
+    p.freq_hz = {0.0, 25.0, 50.0};
+    p.psd = {std::vector<double>{1e-6, 2e-6, 3e-6}, std::vector<double>{0.5, 0.25, 0.125}, std::vector<double>{}};
+    r.psd = p;
+
+    CHECK(sla::report_json_text(r) == sla::report_to_json(r).dump(4));
+
+    r.time_axis.dt_available = false;
+    r.reorder.reset();
+    r.psd.reset();
+    r.warnings.clear();
+    CHECK(sla::report_json_text(r) == sla::report_to_json(r).dump(4));
+}
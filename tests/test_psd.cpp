@@ -0,0 +1,73 @@
+#include "sla/fft.hpp"
+#include "sla/psd.hpp"
+#include "sla/synth.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <vector>
+
+TEST_CASE("fft: real FFT matches a direct DFT")
+{
+    for (std::size_t n : {4, 8, 64, 256})
+    {
+        sla::SplitMix64 rng(n);
+        std::vector<double> x(n);
+        for (auto &v : x)
+            v = rng.symmetric(1.0);
+
+        std::vector<double> re(n / 2 + 1), im(n / 2 + 1);
+        sla::RealFft fft(n);
+        fft.forward(x.data(), re.data(), im.data());
+
+        for (std::size_t k = 0; k <= n / 2; ++k)
+        {
+            double dr = 0.0, di = 0.0;
+            for (std::size_t t = 0; t < n; ++t)
+            {
+                const double a = -2.0 * std::numbers::pi * double(k) * double(t) / double(n);
+                dr += x[t] * std::cos(a);
+                di += x[t] * std::sin(a);
+            }
+            CHECK(re[k] == Catch::Approx(dr).margin(1e-9));
+            CHECK(im[k] == Catch::Approx(di).margin(1e-9));
+        }
+    }
+}
+
+TEST_CASE("psd: sine shows up at its frequency, total power matches the variance")
+{
+    const double fs = 1000.0, f0 = 125.0, amp = 2.0;
+    sla::WelchPsd psd(256);
+
+    sla::SplitMix64 rng(3);
+    for (int i = 0; i < 256 * 40; ++i)
+    {
+        const double s = amp * std::sin(2.0 * std::numbers::pi * f0 * i / fs);
+        psd.update(s, rng.symmetric(0.1), 9.81);
+    }
+
+    auto r = psd.report(fs);
+    CHECK(r.segments == 79);   // 1 + (40*256 - 256) / 128
+    REQUIRE(r.freq_hz.size() == 129);
+
+    std::size_t peak = 0;
+    for (std::size_t k = 1; k < r.psd[0].size(); ++k)
+        if (r.psd[0][k] > r.psd[0][peak])
+            peak = k;
+    CHECK(r.freq_hz[peak] == Catch::Approx(f0));
+
+    // Parseval: sum(PSD) * df = variance
+    auto power = [&](int a)
+    {
+        double p = 0.0;
+        for (double v : r.psd[a])
+            p += v * fs / 256.0;
+        return p;
+    };
+    CHECK(power(0) == Catch::Approx(amp * amp / 2).epsilon(0.02));
+    CHECK(power(1) == Catch::Approx(0.01 / 3).epsilon(0.05));   // uniform +-0.1
+    CHECK(power(2) == Catch::Approx(0.0).margin(1e-20));        // constant: mean removed
+}
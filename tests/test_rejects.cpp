@@ -0,0 +1,97 @@
+#include "sla/csv.hpp"
+#include "sla/rejects.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// RFC 4180 records of text: fields per record
+static std::vector<std::size_t> csv_field_counts(const std::string &text)
+{
+    std::vector<std::size_t> out;
+    std::size_t fields = 1;
+    bool quoted = false;
+
+    for (std::size_t i = 0; i < text.size(); ++i)
+    {
+        const char c = text[i];
+        if (quoted)
+        {
+            if (c == '"' && i + 1 < text.size() && text[i + 1] == '"')
+                ++i;
+            else if (c == '"')
+                quoted = false;
+        }
+        else if (c == '"')
+            quoted = true;
+        else if (c == ',')
+            fields++;
+        else if (c == '\n')
+        {
+            out.push_back(fields);
+            fields = 1;
+        }
+    }
+    return out;
+}
+
+TEST_CASE("rejects: every bad line with its line number, reason and raw text")
+{
+    const auto dir = std::filesystem::temp_directory_path() / "sla_test_rejects";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    std::size_t bad = 0;
+    {
+        std::ofstream f(dir / "in.csv", std::ios::binary);
+        f << "t_ms,ax,ay,az\n";
+        for (int i = 0; i < 60000; ++i)
+        {
+            f << i * 10 << ",0.1,0.2,9.8\n";
+            if (i % 3 == 0)
+            {
+                f << i * 10 + 5 << ",0.1,\"x\",9.8\n";   // > 1 chunk of rejects in total
+                bad++;
+            }
+        }
+        f << "1,2,3\r\n";
+        bad++;
+    }
+
+    sla::RejectWriter rejects;
+    REQUIRE(rejects.open(dir / "rejects.csv"));
+
+    const auto r = sla::read_imu_csv_streaming_located(dir / "in.csv", {},
+        [&](const sla::RejectedLine &l) { rejects.write(l); });
+    rejects.close();
+
+    REQUIRE(r.ok);
+    CHECK(rejects.ok());
+    CHECK(rejects.rejects() == bad);
+    CHECK(r.counts.bad_lines == bad);
+
+    std::ifstream in(dir / "rejects.csv", std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string text = ss.str();
+
+    CHECK(text.rfind("line,reason,raw\n3,\"invalid value in column 3\",\"5,0.1,\"\"x\"\",9.8\"\n", 0) == 0);
+    CHECK(text.size() > sla::RejectWriter::CHUNK);
+
+    const std::string tail = "\"incorrect number of columns (expected 4, got 3)\",\"1,2,3\r\"\n";
+    REQUIRE(text.size() > tail.size());
+    CHECK(text.compare(text.size() - tail.size(), tail.size(), tail) == 0);
+
+    // header + one record per bad line, each exactly line,reason,raw
+    const auto fields = csv_field_counts(text);
+    CHECK(fields.size() == bad + 1);
+    CHECK(static_cast<std::size_t>(std::count(fields.begin(), fields.end(), 3)) == fields.size());
+
+    CHECK_FALSE(sla::RejectWriter().open("-"));
+
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,54 @@
+#include "sla/reorder.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <vector>
+
+using Row = std::array<double, 4>;
+
+static std::vector<double> run_reorder(const std::vector<Row> &rows, std::size_t window, bool dedup,
+                                       sla::ReorderStats &stats)
+{
+    std::vector<double> out;
+    sla::ReorderBuffer rb(window, dedup, [&](const Row &r) { out.push_back(r[0]); });
+    for (const auto &r : rows)
+        rb.push(r);
+    rb.flush();
+    stats = rb.stats();
+    return out;
+}
+
+TEST_CASE("reorder: rows displaced within the window come out sorted")
+{
+    sla::ReorderStats st;
+    auto out = run_reorder({{0, 1, 1, 1}, {20, 1, 1, 1}, {10, 1, 1, 1}, {30, 1, 1, 1}, {25, 1, 1, 1}, {40, 1, 1, 1}},
+                           2, false, st);
+
+    CHECK(out == std::vector<double>{0, 10, 20, 25, 30, 40});
+    CHECK(st.reordered == 2);
+    CHECK(st.late_dropped == 0);
+}
+
+TEST_CASE("reorder: rows older than the window are dropped")
+{
+    sla::ReorderStats st;
+    auto out = run_reorder({{10, 0, 0, 0}, {20, 0, 0, 0}, {30, 0, 0, 0}, {40, 0, 0, 0}, {5, 0, 0, 0}},
+                           1, false, st);
+
+    CHECK(out == std::vector<double>{10, 20, 30, 40});
+    CHECK(st.late_dropped == 1);
+}
+
+TEST_CASE("reorder: exact duplicates collapse, equal timestamps with other values stay")
+{
+    const std::vector<Row> rows{{0, 1, 2, 3}, {10, 1, 2, 3}, {10, 1, 2, 3}, {10, 9, 9, 9}, {10, 1, 2, 3}, {20, 0, 0, 0}};
+
+    sla::ReorderStats st;
+    auto out = run_reorder(rows, 4, true, st);
+    CHECK(out == std::vector<double>{0, 10, 10, 20});
+    CHECK(st.duplicates_dropped == 2);
+
+    out = run_reorder(rows, 4, false, st);
+    CHECK(out.size() == rows.size());
+    CHECK(st.duplicates_dropped == 0);
+}
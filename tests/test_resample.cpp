@@ -0,0 +1,88 @@
+#include "sla/resample.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <array>
+#include <vector>
+
+using Row = std::array<double, 4>;
+
+static std::vector<Row> run_resampler(const sla::ResampleOptions &opt, const std::vector<Row> &rows,
+                                      sla::ResampleResult &res)
+{
+    std::vector<Row> out;
+    sla::Resampler rs(opt, res, [&](const Row &r) { out.push_back(r); });
+    for (const auto &r : rows)
+        rs.push(r);
+    return out;
+}
+
+TEST_CASE("resample: linear interpolation onto a uniform grid")
+{
+    sla::ResampleOptions opt;
+    opt.rate_hz = 1000.0;   // 1 ms grid
+
+    sla::ResampleResult res;
+    auto out = run_resampler(opt, {{10.0, 0.0, 0.0, 0.0}, {12.5, 5.0, -5.0, 1.0}, {14.0, 5.0, -5.0, 1.0}}, res);
+
+    REQUIRE(out.size() == 5);   // 10, 11, 12, 13, 14
+    CHECK(out[1][0] == 11.0);
+    CHECK(out[1][1] == Catch::Approx(2.0));
+    CHECK(out[2][2] == Catch::Approx(-4.0));
+    CHECK(out[3][1] == Catch::Approx(5.0));
+    CHECK(out[4][0] == 14.0);
+}
+
+TEST_CASE("resample: nearest kernel picks the closer sample")
+{
+    sla::ResampleOptions opt;
+    opt.rate_hz = 1000.0;
+    opt.kernel = sla::ResampleKernel::Nearest;
+
+    sla::ResampleResult res;
+    auto out = run_resampler(opt, {{0.0, 1.0, 1.0, 1.0}, {3.0, 2.0, 2.0, 2.0}}, res);
+
+    REQUIRE(out.size() == 4);
+    CHECK(out[1][1] == 1.0);
+    CHECK(out[2][1] == 2.0);
+}
+
+TEST_CASE("resample: split policy leaves gaps empty, non-increasing rows are skipped")
+{
+    sla::ResampleOptions opt;
+    opt.rate_hz = 100.0;    // 10 ms grid
+    opt.max_gap_ms = 25.0;
+    opt.gap_policy = sla::GapPolicy::Split;
+
+    const std::vector<Row> rows{{0, 0, 0, 0}, {10, 0, 0, 0}, {5, 0, 0, 0}, {60, 0, 0, 0}, {70, 0, 0, 0}};
+
+    sla::ResampleResult res;
+    auto out = run_resampler(opt, rows, res);
+
+    std::vector<double> t;
+    for (const auto &r : out)
+        t.push_back(r[0]);
+
+    CHECK(t == std::vector<double>{0, 10, 60, 70});
+    CHECK(res.gaps == 1);
+    CHECK(res.grid_points_skipped == 4);
+    CHECK(res.rows_skipped == 1);
+
+    opt.gap_policy = sla::GapPolicy::Fill;
+    sla::ResampleResult filled;
+    CHECK(run_resampler(opt, rows, filled).size() == 8);
+}
+
+TEST_CASE("resample: grid is anchored at multiples of the period")
+{
+    sla::ResampleOptions opt;
+    opt.rate_hz = 100.0;
+
+    sla::ResampleResult res;
+    auto out = run_resampler(opt, {{-13.0, 0, 0, 0}, {4.0, 0, 0, 0}, {21.0, 0, 0, 0}}, res);
+
+    std::vector<double> t;
+    for (const auto &r : out)
+        t.push_back(r[0]);
+    CHECK(t == std::vector<double>{-10, 0, 10, 20});
+}
@@ -0,0 +1,102 @@
+#include "sla/row_chunks.hpp"
+#include "sla/csv.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+// integer readings: every order of summation gives the same exact sums
+static std::array<double, 4> sample_row(int i)
+{
+    return {10.0 * i, static_cast<double>(i % 13), static_cast<double>((i * 7) % 11) - 5.0,
+            static_cast<double>((i * 3) % 17)};
+}
+
+TEST_CASE("row chunk sums: ranges re-binned with re-read edges, seekable or not")
+{
+    const auto dir = std::filesystem::temp_directory_path();
+    const auto plain = dir / "sla_test_row_chunks.csv";
+    const auto gz = dir / "sla_test_row_chunks.csv.gz";
+
+    const int rows = 1001;
+    std::string data = "t_ms,ax,ay,az\n";
+    for (int i = 0; i < rows; ++i)
+    {
+        const auto r = sample_row(i);
+        data += std::to_string(r[0]) + "," + std::to_string(r[1]) + "," + std::to_string(r[2]) + "," +
+                std::to_string(r[3]) + "\n";
+        if (i == 500)
+            data += "# comment\nbroken,line\n";
+    }
+    std::ofstream(plain, std::ios::binary) << data;
+    {
+        gzFile g = gzopen(gz.string().c_str(), "wb");
+        REQUIRE(g != nullptr);
+        gzwrite(g, data.data(), static_cast<unsigned>(data.size()));
+        gzclose(g);
+    }
+
+    const std::vector<sla::RowRange> ranges{
+        {3, 97, 0},        // inside a few chunks, both edges cut
+        {128, 256, 1},     // aligned
+        {300, 301, 1},     // one row, same target
+        {450, 620, 2},     // across the bad line
+        {990, 5000, 3},    // runs past the end
+        {40, 41, 4},
+    };
+
+    std::vector<sla::Vec3> expected(5);
+    std::vector<std::uint64_t> expected_n(5);
+    for (const auto &r : ranges)
+    {
+        for (std::uint64_t i = r.begin; i < std::min<std::uint64_t>(r.end, rows); ++i)
+        {
+            const auto v = sample_row(static_cast<int>(i));
+            expected[r.target].x += v[1];
+            expected[r.target].y += v[2];
+            expected[r.target].z += v[3];
+            expected_n[r.target]++;
+        }
+    }
+
+    for (const auto &path : {plain, gz})
+    {
+        sla::RowChunkSums chunks(16);   // merged down to 64-row chunks
+        auto r = sla::read_imu_csv_streaming_located(path,
+            [&](const std::array<double, 4> &row, const sla::RowLocation &loc) { chunks.add(row, loc.byte_offset); });
+        REQUIRE(r.ok);
+        chunks.finish();
+
+        CHECK(chunks.rows() == rows);
+        CHECK(chunks.chunk_rows() == 64);
+        CHECK(chunks.chunks() == 16);
+
+        std::vector<sla::Vec3> sum;
+        std::vector<std::uint64_t> n;
+        std::string err;
+        REQUIRE(sla::sum_row_ranges(path, chunks, ranges, 5, sum, n, err));
+
+        for (std::size_t t = 0; t < 5; ++t)
+        {
+            CHECK(n[t] == expected_n[t]);
+            CHECK(sum[t].x == expected[t].x);
+            CHECK(sum[t].y == expected[t].y);
+            CHECK(sum[t].z == expected[t].z);
+        }
+    }
+
+    // seeking into a line of the plain file picks up from there
+    int seen = 0;
+    auto part = sla::read_imu_csv_streaming_at(plain, 14, 3, [&](const std::array<double, 4> &) { seen++; });
+    REQUIRE(part.ok);
+    CHECK(seen == 3);
+    CHECK_FALSE(sla::read_imu_csv_streaming_at(gz, 14, 3, {}).ok);
+
+    std::filesystem::remove(plain);
+    std::filesystem::remove(gz);
+}
@@ -0,0 +1,138 @@
+#include "sla/steady.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <array>
+#include <vector>
+
+// still at a, rotate over `ramp` rows, still at b
+static void feed(sla::SteadySegmenter &seg, std::array<double, 3> a, std::array<double, 3> b,
+                 int still_a, int ramp, int still_b)
+{
+    for (int i = 0; i < still_a; ++i)
+        seg.push(a[0] + ((i % 2) ? 0.001 : -0.001), a[1], a[2]);
+    for (int i = 0; i < ramp; ++i)
+    {
+        const double f = (i + 1.0) / (ramp + 1.0);
+        seg.push(a[0] + f * (b[0] - a[0]), a[1] + f * (b[1] - a[1]), a[2] + f * (b[2] - a[2]));
+    }
+    for (int i = 0; i < still_b; ++i)
+        seg.push(b[0], b[1], b[2] + ((i % 2) ? 0.001 : -0.001));
+}
+
+TEST_CASE("steady segmenter: still runs split by a rotation")
+{
+    sla::SteadyOptions opt;
+    opt.window = 10;
+    opt.threshold = 0.05;
+    sla::SteadySegmenter seg(opt);
+
+    feed(seg, {0.0, 0.0, 9.81}, {9.81, 0.0, 0.0}, 200, 50, 300);
+    seg.finish();
+
+    const auto &s = seg.segments();
+    REQUIRE(s.size() == 2);
+
+    CHECK(s[0].begin == 0);
+    CHECK(s[0].end > 195);
+    CHECK(s[0].end <= 201);
+    CHECK(s[0].mean[2] == Catch::Approx(9.81));
+
+    CHECK(s[1].begin >= 249);
+    CHECK(s[1].begin < 255);
+    CHECK(s[1].end == 550);
+    CHECK(s[1].mean[0] == Catch::Approx(9.81));
+    CHECK(s[1].mean[2] == Catch::Approx(0.0).margin(1e-9));
+}
+
+TEST_CASE("steady segmenter: short pauses are ignored")
+{
+    sla::SteadyOptions opt;
+    opt.window = 10;   // min_rows defaults to 20
+    sla::SteadySegmenter seg(opt);
+
+    feed(seg, {0.0, 0.0, 9.81}, {0.0, 9.81, 0.0}, 15, 40, 15);
+    seg.finish();
+    CHECK(seg.segments().empty());
+}
+
+TEST_CASE("steady matching: in order, skipping segments that fit no position")
+{
+    auto segment = [](std::uint64_t b, std::uint64_t e, std::array<double, 3> m)
+    {
+        sla::SteadySegment s;
+        s.begin = b;
+        s.end = e;
+        s.mean = m;
+        return s;
+    };
+
+    const std::vector<sla::SteadySegment> segs{
+        segment(0, 100, {0.0, 0.0, 9.8}),      // position 0
+        segment(150, 170, {5.0, 0.0, 5.0}),    // paused half way: 45 deg off both
+        segment(200, 300, {9.8, 0.0, 0.2}),    // position 1
+        segment(310, 400, {9.8, 0.1, 0.0}),    // position 1 again after a bump
+        segment(450, 500, {0.0, 0.0, 9.8}),    // back at the start: nothing left to match
+    };
+    const std::vector<std::array<double, 3>> expected{{0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}};
+
+    const auto m = sla::match_steady_segments(segs, expected, 10.0);
+    REQUIRE(m.size() == 5);
+    CHECK(m[0] == 0);
+    CHECK(m[1] == -1);
+    CHECK(m[2] == 1);
+    CHECK(m[3] == 1);
+    CHECK(m[4] == -1);
+
+    // the positions must come in capture order
+    const std::vector<std::array<double, 3>> reversed{{1.0, 0.0, 0.0}, {0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}};
+    CHECK(sla::match_steady_segments(segs, reversed, 10.0).empty());
+}
+
+TEST_CASE("steady clustering: any order, several dwells per position")
+{
+    auto segment = [](std::uint64_t b, std::uint64_t e, std::array<double, 3> m)
+    {
+        sla::SteadySegment s;
+        s.begin = b;
+        s.end = e;
+        s.mean = m;
+        return s;
+    };
+
+    // biased readings (a few degrees off) of three positions, out of order
+    const std::vector<sla::SteadySegment> segs{
+        segment(0, 100, {9.7, 0.3, 0.2}),       // x
+        segment(150, 170, {5.0, 0.0, 5.0}),     // between x and z: 45 deg off both
+        segment(200, 400, {0.2, 0.3, 9.9}),     // z
+        segment(450, 500, {0.1, 9.8, -0.4}),    // y
+        segment(520, 600, {9.8, 0.2, 0.3}),     // x again
+    };
+    const std::vector<std::array<double, 3>> expected{{0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}};
+
+    const auto m = sla::cluster_steady_segments(segs, expected, 10.0);
+    REQUIRE(m.size() == 5);
+    CHECK(m[0] == 1);
+    CHECK(m[1] == -1);
+    CHECK(m[2] == 0);
+    CHECK(m[3] == 2);
+    CHECK(m[4] == 1);
+
+    // in capture order the same segments don't fit
+    CHECK(sla::match_steady_segments(segs, expected, 10.0).empty());
+
+    // a position nobody visited
+    const std::vector<std::array<double, 3>> four{{0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, -1.0}};
+    CHECK(sla::cluster_steady_segments(segs, four, 10.0).empty());
+
+    // positions with the same direction share the cluster in capture order
+    const std::vector<std::array<double, 3>> twice{{1.0, 0.0, 0.0}, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {1.0, 0.0, 0.0}};
+    const auto t = sla::cluster_steady_segments(segs, twice, 10.0);
+    REQUIRE(t.size() == 5);
+    CHECK(t[0] == 0);
+    CHECK(t[4] == 3);
+
+    // but close, different directions are ambiguous
+    const std::vector<std::array<double, 3>> close{{1.0, 0.0, 0.0}, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {1.0, 0.1, 0.0}};
+    CHECK(sla::cluster_steady_segments(segs, close, 10.0).empty());
+}
@@ -2,6 +2,8 @@
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
+#include <algorithm>
+#include <random>
 #include <vector>
 
 static sla::TimeAxisReport run_time_axis(const std::vector<double>& ts)
@@ -42,7 +44,7 @@ TEST_CASE("time_axis: non-increasing dt<0")
     CHECK(rep.anomalies.duplicates == 0);
 }
 
-TEST_CASE("time_axis: gap dt > 2*mean_dt")
+TEST_CASE("time_axis: gap dt > 2*median dt")
 {
     auto rep = run_time_axis({0.0, 10.0, 20.0, 61.0});
     CHECK(rep.dt_available);
@@ -55,4 +57,123 @@ TEST_CASE("time_axis: no positive dt -> dt_available false")
     CHECK(!rep.dt_available);
     CHECK(rep.dt_ms.count == 0);
     CHECK(rep.anomalies.duplicates == 2);
-}
\ No newline at end of file
+}
+
+TEST_CASE("time_axis: events carry location and t before/after")
+{
+    sla::TimeAxisAccumulator acc;
+    const double ts[] = {0.0, 10.0, 20.0, 61.0, 71.0, 65.0};
+    for (std::size_t i = 0; i < 6; ++i)
+        acc.update(ts[i], i + 2, 100 * i);   // line 1 is the header
+
+    auto rep = acc.report();
+    REQUIRE(rep.events.size() == 2);
+
+    const auto &gap = rep.events[0];
+    CHECK(gap.kind == sla::TimeAxisEventKind::Gap);
+    CHECK(gap.row == 3);
+    CHECK(gap.line == 5);
+    CHECK(gap.byte_offset == 300);
+    CHECK(gap.t_before == 20.0);
+    CHECK(gap.t_after == 61.0);
+    CHECK(gap.dt == Catch::Approx(41.0));
+    CHECK(gap.count == 1);
+
+    CHECK(rep.events[1].kind == sla::TimeAxisEventKind::NonIncreasing);
+    CHECK(rep.events[1].dt == Catch::Approx(-6.0));
+}
+
+TEST_CASE("time_axis: consecutive anomalies collapse into one run")
+{
+    auto rep = run_time_axis({0.0, 10.0, 10.0, 10.0, 10.0, 20.0, 20.0});
+    CHECK(rep.anomalies.duplicates == 4);
+    REQUIRE(rep.events.size() == 2);
+    CHECK(rep.events[0].kind == sla::TimeAxisEventKind::Duplicate);
+    CHECK(rep.events[0].row == 2);
+    CHECK(rep.events[0].count == 3);
+    CHECK(rep.events[1].row == 6);
+    CHECK(rep.events[1].count == 1);
+}
+
+TEST_CASE("time_axis: event list is bounded")
+{
+    sla::TimeAxisAccumulator acc(2);
+    for (double t : {0.0, 10.0, 10.0, 20.0, 20.0, 30.0, 30.0, 40.0, 40.0})
+        acc.update(t);
+
+    auto rep = acc.report();
+    CHECK(rep.anomalies.duplicates == 4);
+    CHECK(rep.events.size() == 2);
+    CHECK(rep.events_dropped == 2);
+}
+
+TEST_CASE("dt histogram: median and mode ignore outliers")
+{
+    sla::DtHistogram h;
+    for (int i = 0; i < 1000; ++i)
+        h.add(i % 5 < 2 ? 9.9 : 10.1);   // jitter around 10 ms
+    h.add(500.0);                    // a long gap
+    h.add(1e-12);                    // clamped into the first bucket
+
+    CHECK(h.count() == 1002);
+    CHECK(h.median() == Catch::Approx(10.1));
+    CHECK(h.mode() == Catch::Approx(10.1));
+    CHECK(h.quantile(1.0) == 500.0);
+    CHECK(sla::DtHistogram::bucket_index(1e-12) == 0);
+    CHECK(sla::DtHistogram::bucket_index(1e300) == sla::DtHistogram::BUCKETS - 1);
+}
+
+TEST_CASE("time_axis: median of jittered timestamps within 0.1% of the true dt")
+{
+    // uniform timestamp jitter, as `sla gen --jitter`: dt is triangular around
+    // the period, whose median often sits on a bucket edge
+    struct Case
+    {
+        double period_ms;
+        double jitter_ms;
+    };
+
+    for (const Case c : {Case{10.0, 0.3}, Case{1.0, 0.05}, Case{1.0, 0.3}, Case{10.0, 2.0}, Case{2.5, 0.1}})
+    {
+        std::mt19937_64 rng(7);
+        std::uniform_real_distribution<double> jitter(-c.jitter_ms, c.jitter_ms);
+
+        std::vector<double> ts(200000);
+        for (std::size_t i = 0; i < ts.size(); ++i)
+            ts[i] = static_cast<double>(i) * c.period_ms + jitter(rng);
+
+        std::vector<double> dts;
+        sla::DtHistogram h;
+        for (std::size_t i = 1; i < ts.size(); ++i)
+        {
+            dts.push_back(ts[i] - ts[i - 1]);
+            h.add(dts.back());
+        }
+        std::nth_element(dts.begin(), dts.begin() + dts.size() / 2, dts.end());
+        const double exact_median = dts[dts.size() / 2];
+
+        CHECK(h.median() == Catch::Approx(exact_median).epsilon(1e-3));
+
+        const auto rep = run_time_axis(ts);
+        CHECK(rep.dt_median_ms == Catch::Approx(c.period_ms).epsilon(1e-3));
+        CHECK(rep.sampling_hz_est == Catch::Approx(1000.0 / c.period_ms).epsilon(1e-3));
+        CHECK(rep.dt_mode_ms == Catch::Approx(c.period_ms).epsilon(2e-2));
+    }
+}
+
+TEST_CASE("time_axis: rate from median is not skewed by gaps")
+{
+    std::vector<double> ts;
+    double t = 0.0;
+    for (int i = 0; i < 2000; ++i)
+    {
+        ts.push_back(t);
+        t += (i % 500 == 499) ? 200.0 : 5.0;   // 200 Hz with a 200 ms dropout every 500 rows
+    }
+
+    auto rep = run_time_axis(ts);
+    CHECK(rep.dt_median_ms == 5.0);
+    CHECK(rep.sampling_hz_est == Catch::Approx(200.0));
+    CHECK(rep.dt_ms.mean > 5.0);
+    CHECK(rep.anomalies.gaps == 3);
+}
@@ -0,0 +1,126 @@
+#include "sla/csv.hpp"
+#include "sla/warning_summary.hpp"
+#include "sla/report_json.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+TEST_CASE("warning summary: counts per category, samples spread over the input")
+{
+    sla::WarningSummary s;
+    for (std::uint64_t line = 1; line <= 10000; ++line)
+        s.add(sla::WarningKind::InvalidValue, 2, line, "x" + std::to_string(line));
+    s.add(sla::WarningKind::ColumnCount, 3, 5, "1,2,3");
+    s.add(sla::WarningKind::ColumnCount, 500, 6, std::string(600, ','));
+    s.add(sla::WarningKind::ColumnCount, 40, 7, "1,2");
+
+    const auto cats = s.take();
+    REQUIRE(cats.size() == 3);
+
+    CHECK(cats[0].kind == sla::WarningKind::ColumnCount);
+    CHECK(cats[0].detail == 3);
+    CHECK(cats[0].message() == "incorrect number of columns (expected 4, got 3)");
+    CHECK(cats[0].sample_count == 1);
+    CHECK(cats[0].samples[0].text() == "1,2,3");
+
+    // wide lines share one capped category; their text is cut
+    CHECK(cats[1].detail == sla::WARNING_MAX_COLUMNS);
+    CHECK(cats[1].count == 2);
+    CHECK(cats[1].message() == "incorrect number of columns (expected 4, got 32 or more)");
+    CHECK(cats[1].samples[0].text().size() == sla::WARNING_TEXT_MAX);
+    CHECK(cats[1].samples[0].truncated);
+    CHECK_FALSE(cats[1].samples[1].truncated);
+
+    const auto &v = cats[2];
+    CHECK(v.message() == "invalid value");
+    CHECK(v.count == 10000);
+    CHECK(v.first_line == 1);
+    CHECK(v.last_line == 10000);
+    REQUIRE(v.sample_count == sla::WARNING_SAMPLES);
+
+    // sorted by line, consistent with their text, and not just the first lines
+    for (std::size_t i = 0; i < v.sample_count; ++i)
+    {
+        CHECK(v.samples[i].text() == "x" + std::to_string(v.samples[i].line));
+        if (i > 0)
+            CHECK(v.samples[i - 1].line < v.samples[i].line);
+    }
+    CHECK(v.samples[v.sample_count - 1].line > 5000);
+
+    // a cut never splits a UTF-8 character
+    sla::WarningSummary u;
+    u.add(sla::WarningKind::InvalidValue, 1, 1, std::string(sla::WARNING_TEXT_MAX - 1, 'a') + "\xc3\xa9");
+    const auto ucats = u.take();
+    CHECK(ucats[0].samples[0].text() == std::string(sla::WARNING_TEXT_MAX - 1, 'a'));
+}
+
+TEST_CASE("warning summary: csv reader categorises every bad line")
+{
+    const auto path = std::filesystem::temp_directory_path() / "sla_test_warning_summary.csv";
+    {
+        std::ofstream f(path);
+        f << "t_ms,ax,ay,az\n";
+        for (int i = 0; i < 1000; ++i)
+        {
+            f << i * 10 << ",0.1,0.2,9.8\n";
+            if (i % 4 == 0)
+                f << i * 10 + 5 << ",0.1,bad,9.8\n";
+            if (i % 100 == 0)
+                f << "1,2,3\n";
+        }
+    }
+
+    const auto r = sla::read_imu_csv_streaming(path, {});
+    REQUIRE(r.ok);
+    CHECK(r.counts.bad_lines == 260);
+    CHECK(r.warnings.size() == 200);
+    CHECK(r.warnings_dropped == 60);
+
+    REQUIRE(r.warning_categories.size() == 2);
+    CHECK(r.warning_categories[0].kind == sla::WarningKind::ColumnCount);
+    CHECK(r.warning_categories[0].count == 10);
+    CHECK(r.warning_categories[1].detail == 3);
+    CHECK(r.warning_categories[1].count == 250);
+    CHECK(r.warning_categories[1].samples[0].text() == "bad");
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("warning summary: bad lines that aren't UTF-8 still give a valid report")
+{
+    const auto path = std::filesystem::temp_directory_path() / "sla_test_warning_latin1.csv";
+    {
+        std::ofstream f(path, std::ios::binary);
+        f << "t_ms,ax,ay,az\n0,0,0,9.8\n\xff\xfe garbage\n1,0,\xe9t\xe9,9.8\n2,0,0,9.8\n";
+    }
+
+    const auto r = sla::read_imu_csv_streaming(path, {});
+    REQUIRE(r.ok);
+    REQUIRE(r.warning_categories.size() == 2);
+    CHECK(r.warning_categories[0].samples[0].text() == "\xef\xbf\xbd\xef\xbf\xbd garbage");
+    CHECK(r.warning_categories[1].samples[0].text() == "\xef\xbf\xbdt\xef\xbf\xbd");
+    REQUIRE(r.warnings.size() == 2);
+    CHECK(r.warnings[1].value == std::string("\xef\xbf\xbdt\xef\xbf\xbd"));
+
+    sla::Report rep;
+    rep.input = r.input_name;
+    rep.counts = r.counts;
+    rep.warnings = r.warnings;
+    rep.warning_categories = r.warning_categories;
+
+    std::string text;
+    REQUIRE_NOTHROW(text = sla::report_json_text(rep));
+    CHECK(text == sla::report_to_json(rep).dump(4));
+    CHECK(text.find("\xef\xbf\xbd\xef\xbf\xbd garbage") != std::string::npos);
+
+    // replacement characters count against the fixed buffer like any other
+    sla::WarningSummary s;
+    s.add(sla::WarningKind::ColumnCount, 1, 1, std::string(100, '\xff'));
+    const auto cats = s.take();
+    CHECK(cats[0].samples[0].text().size() == sla::WARNING_TEXT_MAX / 3 * 3);
+    CHECK(cats[0].samples[0].truncated);
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,28 @@
+#include "sla/writer.hpp"
+#include "sla/report_json.hpp"
+#include "sla/allan.hpp"
+#include "sla/calib_sweep.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+
+TEST_CASE("output paths: named after the decompressed input")
+{
+    using std::filesystem::path;
+
+    CHECK(sla::strip_compression_extension("data/d.csv.gz") == path("data/d.csv"));
+    CHECK(sla::strip_compression_extension("data/d.csv.zst") == path("data/d.csv"));
+    CHECK(sla::strip_compression_extension("data/d.csv") == path("data/d.csv"));
+
+    for (const char *in : {"data/d.csv", "data/d.csv.gz", "data/d.csv.zst"})
+    {
+        CHECK(sla::make_clean_path(in) == path("data/d_clean.csv"));
+        CHECK(sla::make_calib_path(in) == path("data/d_calib.csv"));
+        CHECK(sla::make_resample_path(in) == path("data/d_resampled.csv"));
+        CHECK(sla::make_allan_path(in) == path("data/d_allan.json"));
+        CHECK(sla::make_sweep_path(in) == path("data/d_calib_sweep.csv"));
+        CHECK(sla::default_report_json_path(in) == path("data/d.json"));
+    }
+
+    CHECK(sla::make_clean_path("d.gz") == path("d_clean"));
+}